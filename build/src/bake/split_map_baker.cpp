@@ -0,0 +1,173 @@
+#include <stdafx.h>
+#include "split_map_baker.h"
+
+#include "timer/platform_timer.h"
+#include "stb/stb_image_write.h"
+
+// Rows of the target rasterized by one job
+#define BAKE_BAND_HEIGHT 64
+
+struct PngFile
+{
+    FILE*   pFile;
+    uint64  bytesWritten;
+};
+
+static FILE* OpenForWriting(const string& path)
+{
+#ifdef PLATFORM_WIN32
+    FILE* pFile = nullptr;
+    return fopen_s(&pFile, path.c_str(), "wb") == 0 ? pFile : nullptr;
+#else
+    return fopen(path.c_str(), "wb");
+#endif
+}
+
+static void WritePngData(void* pContext, void* pData, int size)
+{
+    PngFile* pFile = (PngFile*)pContext;
+    pFile->bytesWritten += fwrite(pData, 1, size, pFile->pFile);
+}
+
+//----------------------------------------------------------------------
+SplitMapBaker::SplitMapBaker(uint32 width, uint32 height, uint32 numRasterThreads, uint32 numIoThreads)
+    : m_width(width), m_height(height), m_jobSystem(numRasterThreads),
+      m_encodeTicks(0), m_bytesWritten(0), m_failedImages(0), m_ioQueue(numIoThreads)
+{
+}
+
+//----------------------------------------------------------------------
+template<typename TIndex>
+void SplitMapBaker::Bake(const SplitMapMesh<TIndex>& mesh, const std::vector<BakeLayer>& layers, const string& outputPrefix)
+{
+    const uint32 numLayers = std::min((uint32)layers.size(), 32u);
+    if (numLayers == 0)
+        return;
+
+    // Only keep a couple of bakes in flight, every one of them holds a float target
+    m_ioQueue.Wait(numLayers);
+
+    uint64 startTicks = OS::PlatformTimer::getTicks();
+
+    // Vertex processing: position and weight of every layer once per vertex. A layer is
+    // only written by triangles with a weight that is visible in 8 bit on any vertex, with
+    // the same rounding as FloatBitmap::GetChannelGray().
+    m_positions.resize(mesh.vertexCount);
+    m_attributes.resize((size_t)mesh.vertexCount * numLayers);
+    m_layerMasks.resize(mesh.vertexCount);
+    for (uint32 v = 0; v < mesh.vertexCount; v++)
+    {
+        m_positions[v] = { mesh.pTexCoords[2 * v] * m_width, mesh.pTexCoords[2 * v + 1] * m_height };
+
+        uint32 mask = 0;
+        f32* pAttributes = &m_attributes[(size_t)v * numLayers];
+        for (uint32 l = 0; l < numLayers; l++)
+        {
+            f64 weight = 0.0;
+            for (int map : layers[l].weightMaps)
+                if (map >= 0 && (uint32)map < mesh.weightMapCount)
+                    weight += mesh.ppWeightMaps[map][v];
+
+            pAttributes[l] = (f32)std::min(weight, 1.0);
+            if (pAttributes[l] * 255.0f + 0.5f >= 1.0f)
+                mask |= 1u << l;
+        }
+        m_layerMasks[v] = mask;
+    }
+
+    // Triangle setup, once for all layers
+    m_triangles.clear();
+    for (uint32 idx = 0; idx + 2 < mesh.indexCount; idx += 3)
+    {
+        BakeTriangle tri;
+        for (int i = 0; i < 3; i++)
+            tri.vertices[i] = mesh.pIndices[idx + i];
+        if (tri.vertices[0] >= mesh.vertexCount || tri.vertices[1] >= mesh.vertexCount || tri.vertices[2] >= mesh.vertexCount)
+            continue;
+
+        tri.layerMask = m_layerMasks[tri.vertices[0]] | m_layerMasks[tri.vertices[1]] | m_layerMasks[tri.vertices[2]];
+        if (tri.layerMask == 0)
+            continue;
+
+        Triangle2D t{ m_positions[tri.vertices[0]], m_positions[tri.vertices[1]], m_positions[tri.vertices[2]], 0, 0, 0 };
+        if (SetupTriangle(t, m_width, m_height, tri.setup))
+            m_triangles.push_back(tri);
+    }
+
+    // Rasterize horizontal bands in parallel, every band keeps the submission order
+    auto target = std::make_shared<FloatBitmap>(m_width, m_height, numLayers);
+    uint32 numBands = (m_height + BAKE_BAND_HEIGHT - 1) / BAKE_BAND_HEIGHT;
+    m_jobSystem.ParallelFor(numBands, [&](uint32 band)
+    {
+        int32 bandMinY = band * BAKE_BAND_HEIGHT;
+        int32 bandMaxY = std::min(bandMinY + BAKE_BAND_HEIGHT, (int32)m_height) - 1;
+        for (const BakeTriangle& tri : m_triangles)
+        {
+            if (tri.setup.maxY < bandMinY || tri.setup.minY > bandMaxY)
+                continue;
+
+            const f32* pAttributes[3] = { &m_attributes[(size_t)tri.vertices[0] * numLayers],
+                                          &m_attributes[(size_t)tri.vertices[1] * numLayers],
+                                          &m_attributes[(size_t)tri.vertices[2] * numLayers] };
+            RasterizeTriangleChannels(*target, tri.setup, pAttributes, tri.layerMask,
+                                      tri.setup.minX, std::max(tri.setup.minY, bandMinY), tri.setup.maxX, std::min(tri.setup.maxY, bandMaxY));
+        }
+    });
+
+    m_stats.rasterTicks += OS::PlatformTimer::getTicks() - startTicks;
+    m_stats.bakes++;
+
+    // Encoding happens in the background, the tasks share ownership of the target
+    for (uint32 l = 0; l < numLayers; l++)
+    {
+        string path = outputPrefix + layers[l].name + ".png";
+        m_ioQueue.Push([this, target, l, path]()
+        {
+            uint64 encodeStart = OS::PlatformTimer::getTicks();
+
+            std::vector<uint8> gray((size_t)target->GetWidth() * target->GetHeight());
+            target->GetChannelGray(l, gray.data());
+
+            // Short writes set the error flag of the file, fclose() reports failed flushes
+            bool bWritten = false;
+            FILE* pFile = OpenForWriting(path);
+            if (pFile)
+            {
+                PngFile file{ pFile, 0 };
+                bWritten = stbi_write_png_to_func(WritePngData, &file, target->GetWidth(), target->GetHeight(), 1, gray.data(), target->GetWidth()) != 0;
+                bWritten &= ferror(pFile) == 0;
+                bWritten &= fclose(pFile) == 0;
+                if (bWritten)
+                    m_bytesWritten += file.bytesWritten;
+            }
+
+            if (!bWritten)
+            {
+                printf("Failed to write %s\n", path.c_str());
+                m_failedImages++;
+            }
+
+            m_encodeTicks += OS::PlatformTimer::getTicks() - encodeStart;
+        });
+        m_stats.images++;
+    }
+}
+
+template void SplitMapBaker::Bake(const SplitMapMesh<uint16>& mesh, const std::vector<BakeLayer>& layers, const string& outputPrefix);
+template void SplitMapBaker::Bake(const SplitMapMesh<uint32>& mesh, const std::vector<BakeLayer>& layers, const string& outputPrefix);
+
+//----------------------------------------------------------------------
+void SplitMapBaker::Flush()
+{
+    m_ioQueue.Wait();
+}
+
+//----------------------------------------------------------------------
+BakeStats SplitMapBaker::GetStats() const
+{
+    BakeStats stats = m_stats;
+    stats.encodeTicks = m_encodeTicks;
+    stats.bytesWritten = m_bytesWritten;
+    stats.failedImages = m_failedImages;
+    return stats;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "rasterizer/raster_kernels.h"
+#include "jobs/job_system.h"
+#include "jobs/task_queue.h"
+
+#include <atomic>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Mesh in texture space with one weight per vertex and split map. Indices may be 16 or
+// 32 bit, like in Rasterizer::DrawIndexed().
+////////////////////////////////////////////////////////////////////////////////////////////
+template<typename TIndex>
+struct SplitMapMesh
+{
+    static_assert(std::is_unsigned<TIndex>::value, "Indices must be unsigned integers");
+
+    const f32*          pTexCoords;     // u, v per vertex in [0, 1]
+    uint32              vertexCount;
+    const TIndex*       pIndices;       // Triangle list
+    uint32              indexCount;
+    const f64* const*   ppWeightMaps;   // vertexCount weights per map
+    uint32              weightMapCount;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// One output image, the sum of the listed weight maps
+////////////////////////////////////////////////////////////////////////////////////////////
+struct BakeLayer
+{
+    string              name;
+    std::vector<int>    weightMaps;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct BakeStats
+{
+    uint32  bakes = 0;
+    uint32  images = 0;
+    uint32  failedImages = 0;   // Images which could not be written completely
+    uint64  rasterTicks = 0;    // Vertex processing, setup and rasterization of all bakes
+    uint64  encodeTicks = 0;    // Conversion, compression and writing, summed over all I/O threads
+    uint64  bytesWritten = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Bakes split maps of a mesh. Every bake traverses the mesh once and interpolates all
+// layers at the same time into a multi-channel float target. The layers are then handed
+// to a pool of I/O threads which quantize, compress and write them as 8 bit gray PNGs,
+// while the next bake is already rasterizing.
+////////////////////////////////////////////////////////////////////////////////////////////
+class SplitMapBaker
+{
+public:
+    // 0 threads use all hardware threads
+    SplitMapBaker(uint32 width, uint32 height, uint32 numRasterThreads, uint32 numIoThreads);
+
+    // Writes every layer to "<outputPrefix><layer name>.png". At most 32 layers. Implemented
+    // for uint16 and uint32 indices.
+    template<typename TIndex>
+    void Bake(const SplitMapMesh<TIndex>& mesh, const std::vector<BakeLayer>& layers, const string& outputPrefix);
+
+    // Blocks until all images have been written
+    void Flush();
+
+    // Valid after Flush()
+    BakeStats GetStats() const;
+
+private:
+    struct BakeTriangle
+    {
+        TriangleSetup   setup;
+        uint32          vertices[3];
+        uint32          layerMask;
+    };
+
+    uint32                      m_width;
+    uint32                      m_height;
+    JobSystem                   m_jobSystem;
+
+    std::vector<Point2D>        m_positions;
+    std::vector<f32>            m_attributes;
+    std::vector<uint32>         m_layerMasks;
+    std::vector<BakeTriangle>   m_triangles;
+
+    BakeStats                   m_stats;
+    std::atomic<uint64>         m_encodeTicks;
+    std::atomic<uint64>         m_bytesWritten;
+    std::atomic<uint32>         m_failedImages;
+
+    // Declared last, so it is destroyed first: its destructor finishes the pending tasks,
+    // which still write to the members above
+    TaskQueue                   m_ioQueue;
+
+    // Forbid copy + copy assignment
+    SplitMapBaker(const SplitMapBaker& other)               = delete;
+    SplitMapBaker& operator= (const SplitMapBaker& other)   = delete;
+};
@@ -0,0 +1,215 @@
+#include <stdafx.h>
+#include "benchmark.h"
+#include "present/headless_target.h"
+
+namespace
+{
+    void Append(string& json, const char* format, ...)
+    {
+        char buffer[512];
+
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+
+        json += buffer;
+    }
+
+    string Escape(const char* str)
+    {
+        string escaped;
+        for (; *str; str++)
+        {
+            if (*str == '"' || *str == '\\')
+                escaped += '\\';
+            escaped += *str;
+        }
+        return escaped;
+    }
+
+    // Nearest rank percentile of sorted values
+    f64 Percentile(const std::vector<f64>& sorted, f64 percent)
+    {
+        if (sorted.empty())
+            return 0.0;
+
+        size_t rank = (size_t)ceil(percent / 100.0 * sorted.size());
+        return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+    }
+
+    f64 PerSecond(f64 count, f64 ms)
+    {
+        return ms > 0.0 ? count / (ms / 1000.0) : 0.0;
+    }
+
+    uint64 HashBitmap(const Bitmap& bitmap)
+    {
+        uint64 hash = 14695981039346656037ull;
+        for (uint32 y = 0; y < bitmap.GetHeight(); y++)
+        {
+            const uint8* pBytes = (const uint8*)bitmap.GetRow(y);
+            for (size_t i = 0; i < bitmap.GetWidth() * sizeof(ColorB); i++)
+                hash = (hash ^ pBytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+//----------------------------------------------------------------------
+Benchmark::Benchmark(const BenchmarkSettings& settings)
+    : m_settings(settings)
+{
+}
+
+//----------------------------------------------------------------------
+const BenchmarkResult& Benchmark::Run(const string& name, const BenchmarkFrameFunc& drawFrame)
+{
+    HeadlessTarget target(m_settings.width, m_settings.height);
+    Rasterizer rasterizer(target);
+    rasterizer.SetRasterKernel(m_settings.kernel);
+    rasterizer.SetThreadCount(m_settings.numThreads);
+
+    auto renderFrame = [&](uint32 frame)
+    {
+        PROFILE_ZONE("Frame");
+        rasterizer.Clear();
+        drawFrame(rasterizer, frame);
+        rasterizer.SwapBuffers();
+    };
+
+    uint32 frame = 0;
+    for (; frame < m_settings.warmupFrames; frame++)
+        renderFrame(frame);
+
+    rasterizer.ResetStats();
+    rasterizer.ResetDepthStats();
+    Profiler::Reset();
+
+    std::vector<f64> frameMs;
+    frameMs.reserve(m_settings.frames);
+    for (uint32 i = 0; i < m_settings.frames; i++, frame++)
+    {
+        uint64 startTicks = OS::PlatformTimer::getTicks();
+        renderFrame(frame);
+        frameMs.push_back(OS::PlatformTimer::ticksToMilliSeconds(OS::PlatformTimer::getTicks() - startTicks));
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.kernel = rasterizer.GetRasterKernel();
+    result.threads = rasterizer.GetThreadCount();
+    result.frames = m_settings.frames;
+    result.pixels = (uint64)m_settings.width * m_settings.height * m_settings.frames;
+    result.primitives = rasterizer.GetStats();
+    result.bDepth = rasterizer.GetDepthBuffer() != nullptr;
+    result.depth = rasterizer.GetDepthStats();
+    for (f64 ms : frameMs)
+        result.totalMs += ms;
+
+    std::sort(frameMs.begin(), frameMs.end());
+    if (!frameMs.empty())
+    {
+        result.minMs = frameMs.front();
+        result.maxMs = frameMs.back();
+    }
+    result.p50Ms = Percentile(frameMs, 50.0);
+    result.p99Ms = Percentile(frameMs, 99.0);
+    result.zones = Profiler::GetNodes();
+
+    m_results.push_back(std::move(result));
+    return m_results.back();
+}
+
+//----------------------------------------------------------------------
+std::vector<FrameHash> Benchmark::HashFrames(const BenchmarkFrameFunc& drawFrame, const std::vector<uint32>& threadCounts) const
+{
+    std::vector<FrameHash> hashes;
+    for (RasterKernel kernel : { RasterKernel::Scalar, RasterKernel::SSE2, RasterKernel::AVX2 })
+    {
+        if (ResolveRasterKernel(kernel) != kernel)
+            continue;
+
+        for (uint32 numThreads : threadCounts)
+        {
+            HeadlessTarget target(m_settings.width, m_settings.height);
+            Rasterizer rasterizer(target);
+            rasterizer.SetRasterKernel(kernel);
+            rasterizer.SetThreadCount(numThreads);
+
+            rasterizer.Clear();
+            drawFrame(rasterizer, 0);
+            hashes.push_back({ kernel, rasterizer.GetThreadCount(), HashBitmap(rasterizer.GetBitmap()) });
+        }
+    }
+    return hashes;
+}
+
+//----------------------------------------------------------------------
+string Benchmark::ToJson() const
+{
+    string json = "{\n";
+    Append(json, "  \"width\": %u,\n  \"height\": %u,\n", m_settings.width, m_settings.height);
+    Append(json, "  \"warmupFrames\": %u,\n  \"frames\": %u,\n", m_settings.warmupFrames, m_settings.frames);
+    json += "  \"workloads\": [";
+
+    for (size_t i = 0; i < m_results.size(); i++)
+    {
+        const BenchmarkResult& result = m_results[i];
+        const uint64 triangles = result.primitives.triangles;
+
+        json += i == 0 ? "\n" : ",\n";
+        Append(json, "    {\n      \"name\": \"%s\",\n", Escape(result.name.c_str()).c_str());
+        Append(json, "      \"kernel\": \"%s\",\n      \"threads\": %u,\n", GetRasterKernelName(result.kernel), result.threads);
+        Append(json, "      \"totalMs\": %.4f,\n", result.totalMs);
+        Append(json, "      \"frameMs\": { \"min\": %.4f, \"p50\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+               result.minMs, result.p50Ms, result.p99Ms, result.maxMs);
+        Append(json, "      \"pixelsPerSecond\": %.1f,\n", PerSecond((f64)result.pixels, result.totalMs));
+        Append(json, "      \"filledPixelsPerSecond\": %.1f,\n", PerSecond(result.primitives.triangleArea, result.totalMs));
+        Append(json, "      \"trianglesPerSecond\": %.1f,\n", PerSecond((f64)triangles, result.totalMs));
+        Append(json, "      \"triangles\": %llu,\n      \"trianglesCulled\": %llu,\n      \"lines\": %llu,\n      \"points\": %llu,\n",
+               (unsigned long long)triangles, (unsigned long long)result.primitives.trianglesCulled,
+               (unsigned long long)result.primitives.lines, (unsigned long long)result.primitives.points);
+        if (result.bDepth)
+        {
+            const DepthStats& depth = result.depth;
+            Append(json, "      \"depth\": { \"fragmentsTested\": %llu, \"fragmentsRejected\": %llu, \"fragmentsPassed\": %llu, \"tilesRejected\": %llu, \"pixelsRejected\": %llu, \"tilesAccepted\": %llu },\n",
+                   (unsigned long long)depth.fragmentsTested, (unsigned long long)depth.fragmentsRejected, (unsigned long long)depth.fragmentsPassed,
+                   (unsigned long long)depth.tilesRejected, (unsigned long long)depth.pixelsRejected, (unsigned long long)depth.tilesAccepted);
+        }
+        json += "      \"zones\": [";
+        _WriteZones(json, result, result.zones.empty() ? PROFILE_NODE_NONE : result.zones[0].firstChild, 8);
+        json += "]\n    }";
+    }
+
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+//----------------------------------------------------------------------
+void Benchmark::_WriteZones(string& json, const BenchmarkResult& result, uint32 firstNode, uint32 indent) const
+{
+    const string pad(indent, ' ');
+
+    for (uint32 node = firstNode; node != PROFILE_NODE_NONE; node = result.zones[node].nextSibling)
+    {
+        const ProfileNode& zone = result.zones[node];
+
+        uint64 childTicks = 0;
+        for (uint32 child = zone.firstChild; child != PROFILE_NODE_NONE; child = result.zones[child].nextSibling)
+            childTicks += result.zones[child].ticks;
+
+        const f64 totalMs = OS::PlatformTimer::ticksToMilliSeconds(zone.ticks);
+        json += node == firstNode ? "\n" : ",\n";
+        Append(json, "%s{ \"name\": \"%s\", \"calls\": %llu, \"totalMs\": %.4f, \"selfMs\": %.4f, \"msPerFrame\": %.4f, \"children\": [",
+               pad.c_str(), Escape(zone.name).c_str(), (unsigned long long)zone.calls, totalMs,
+               OS::PlatformTimer::ticksToMilliSeconds(zone.ticks - childTicks), result.frames ? totalMs / result.frames : 0.0);
+
+        if (zone.firstChild != PROFILE_NODE_NONE)
+        {
+            _WriteZones(json, result, zone.firstChild, indent + 2);
+            json += "\n" + pad;
+        }
+        json += "] }";
+    }
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "rasterizer/rasterizer.h"
+#include "profiler/profiler.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchmarkSettings
+{
+    uint32          width = 1024;
+    uint32          height = 1024;
+    RasterKernel    kernel = RasterKernel::Auto;
+    uint32          numThreads = 0;     // 0 uses all hardware threads
+    uint32          warmupFrames = 3;   // Rendered before measuring, not part of the result
+    uint32          frames = 60;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct BenchmarkResult
+{
+    string                      name;
+    RasterKernel                kernel = RasterKernel::Scalar;  // The one that ran, after any fallback
+    uint32                      threads = 1;        // Raster threads that ran
+    uint32                      frames = 0;
+    uint64                      pixels = 0;         // Target pixels of all measured frames
+    RasterStats                 primitives;         // Submitted in all measured frames
+    bool                        bDepth = false;     // Whether the workload used the depth buffer
+    DepthStats                  depth;              // Early-z counters of all measured frames
+    f64                         totalMs = 0.0;
+    f64                         minMs = 0.0;
+    f64                         p50Ms = 0.0;
+    f64                         p99Ms = 0.0;
+    f64                         maxMs = 0.0;
+    std::vector<ProfileNode>    zones;              // Profiler tree of the measured frames
+};
+
+// Draws one frame, the rasterizer is cleared before and presented after it
+using BenchmarkFrameFunc = std::function<void(Rasterizer& rasterizer, uint32 frame)>;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct FrameHash
+{
+    RasterKernel    kernel;
+    uint32          threads;
+    uint64          hash;   // FNV-1a of all pixels
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Runs workloads with a fixed number of frames on a headless target and collects frame
+// times, throughput and profiling zones. The results are written as JSON, so runs on
+// different revisions can be compared by a script.
+////////////////////////////////////////////////////////////////////////////////////////////
+class Benchmark
+{
+public:
+    explicit Benchmark(const BenchmarkSettings& settings);
+
+    // Every workload gets a new rasterizer, nothing carries over from the previous one
+    const BenchmarkResult& Run(const string& name, const BenchmarkFrameFunc& drawFrame);
+
+    inline const std::vector<BenchmarkResult>& GetResults() const { return m_results; }
+    inline const BenchmarkSettings& GetSettings() const { return m_settings; }
+
+    string ToJson() const;
+
+    // Renders the first frame of a workload with every kernel the cpu supports and every
+    // thread count. All of them must give the same frame, stateful workloads do not.
+    std::vector<FrameHash> HashFrames(const BenchmarkFrameFunc& drawFrame, const std::vector<uint32>& threadCounts) const;
+
+private:
+    BenchmarkSettings               m_settings;
+    std::vector<BenchmarkResult>    m_results;
+
+    void _WriteZones(string& json, const BenchmarkResult& result, uint32 firstNode, uint32 indent) const;
+};
\ No newline at end of file
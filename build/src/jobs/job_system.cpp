@@ -0,0 +1,133 @@
+#include <stdafx.h>
+#include "job_system.h"
+
+//----------------------------------------------------------------------
+JobSystem::JobSystem(uint32 numThreads)
+    : m_pFunc(nullptr), m_remainingJobs(0), m_generation(0), m_bQuit(false)
+{
+    if (numThreads == 0)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (uint32 i = 0; i < numThreads; i++)
+        m_queues.push_back(std::make_unique<WorkQueue>());
+
+    // Thread 0 is whoever calls ParallelFor
+    for (uint32 i = 1; i < numThreads; i++)
+        m_workers.emplace_back(&JobSystem::_WorkerLoop, this, i);
+}
+
+//----------------------------------------------------------------------
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bQuit = true;
+    }
+    m_wakeCondition.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+//----------------------------------------------------------------------
+void JobSystem::ParallelFor(uint32 count, const std::function<void(uint32)>& func)
+{
+    if (count == 0)
+        return;
+
+    if (m_workers.empty())
+    {
+        for (uint32 i = 0; i < count; i++)
+            func(i);
+        return;
+    }
+
+    m_pFunc = &func;
+    m_remainingJobs = count;
+
+    // Hand out the jobs round robin, neighbouring jobs end up on different threads
+    uint32 numQueues = GetThreadCount();
+    for (uint32 q = 0; q < numQueues; q++)
+    {
+        std::lock_guard<std::mutex> lock(m_queues[q]->mutex);
+        for (uint32 job = q; job < count; job += numQueues)
+            m_queues[q]->jobs.push_front(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation++;
+    }
+    m_wakeCondition.notify_all();
+
+    _RunJobs(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [this] { return m_remainingJobs == 0; });
+    m_pFunc = nullptr;
+}
+
+//----------------------------------------------------------------------
+void JobSystem::_WorkerLoop(uint32 threadIndex)
+{
+    uint64 seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeCondition.wait(lock, [&] { return m_bQuit || m_generation != seenGeneration; });
+            if (m_bQuit)
+                return;
+            seenGeneration = m_generation;
+        }
+
+        _RunJobs(threadIndex);
+    }
+}
+
+//----------------------------------------------------------------------
+void JobSystem::_RunJobs(uint32 threadIndex)
+{
+    uint32 job;
+    while (_PopJob(threadIndex, job))
+    {
+        (*m_pFunc)(job);
+
+        if (--m_remainingJobs == 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_doneCondition.notify_all();
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+bool JobSystem::_PopJob(uint32 threadIndex, uint32& job)
+{
+    {
+        WorkQueue& own = *m_queues[threadIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+
+    // Own queue is empty, steal from the others
+    uint32 numQueues = GetThreadCount();
+    for (uint32 i = 1; i < numQueues; i++)
+    {
+        WorkQueue& victim = *m_queues[(threadIndex + i) % numQueues];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <atomic>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Small work-stealing thread pool. Every thread owns a queue of job indices, takes work
+// from the back of its own queue and steals from the front of the other queues once its
+// own queue runs dry. The thread calling ParallelFor works on the jobs as well.
+////////////////////////////////////////////////////////////////////////////////////////////
+class JobSystem
+{
+public:
+    // numThreads includes the calling thread, 0 uses all hardware threads
+    explicit JobSystem(uint32 numThreads);
+    ~JobSystem();
+
+    // Runs func(index) for every index in [0, count) and returns once all of them finished
+    void ParallelFor(uint32 count, const std::function<void(uint32)>& func);
+
+    inline uint32 GetThreadCount() const { return (uint32)m_queues.size(); }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex          mutex;
+        std::deque<uint32>  jobs;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread>                m_workers;
+
+    const std::function<void(uint32)>*      m_pFunc;
+    std::atomic<uint32>                     m_remainingJobs;
+
+    std::mutex                              m_mutex;
+    std::condition_variable                 m_wakeCondition;
+    std::condition_variable                 m_doneCondition;
+    uint64                                  m_generation;
+    bool                                    m_bQuit;
+
+    void _WorkerLoop(uint32 threadIndex);
+    void _RunJobs(uint32 threadIndex);
+    bool _PopJob(uint32 threadIndex, uint32& job);
+
+    // Forbid copy + copy assignment
+    JobSystem(const JobSystem& other)               = delete;
+    JobSystem& operator= (const JobSystem& other)   = delete;
+};
@@ -0,0 +1,72 @@
+#include <stdafx.h>
+#include "task_queue.h"
+
+//----------------------------------------------------------------------
+TaskQueue::TaskQueue(uint32 numThreads)
+    : m_pending(0), m_bQuit(false)
+{
+    if (numThreads == 0)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (uint32 i = 0; i < numThreads; i++)
+        m_threads.emplace_back(&TaskQueue::_WorkerLoop, this);
+}
+
+//----------------------------------------------------------------------
+TaskQueue::~TaskQueue()
+{
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bQuit = true;
+    }
+    m_taskCondition.notify_all();
+
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+//----------------------------------------------------------------------
+void TaskQueue::Push(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+        m_pending++;
+    }
+    m_taskCondition.notify_one();
+}
+
+//----------------------------------------------------------------------
+void TaskQueue::Wait(uint32 maxPending)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCondition.wait(lock, [&] { return m_pending <= maxPending; });
+}
+
+//----------------------------------------------------------------------
+void TaskQueue::_WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_taskCondition.wait(lock, [this] { return m_bQuit || !m_tasks.empty(); });
+            if (m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending--;
+        }
+        m_doneCondition.notify_all();
+    }
+}
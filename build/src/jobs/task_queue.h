@@ -0,0 +1,44 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Fire and forget tasks executed in submission order by a fixed set of background threads.
+// Meant for slow work like image encoding and disk I/O that should not stall rendering.
+////////////////////////////////////////////////////////////////////////////////////////////
+class TaskQueue
+{
+public:
+    // 0 uses all hardware threads
+    explicit TaskQueue(uint32 numThreads);
+
+    // Finishes all queued tasks before returning
+    ~TaskQueue();
+
+    void Push(std::function<void()> task);
+
+    // Blocks until at most maxPending tasks are queued or running
+    void Wait(uint32 maxPending = 0);
+
+    inline uint32 GetThreadCount() const { return (uint32)m_threads.size(); }
+
+private:
+    std::vector<std::thread>            m_threads;
+    std::deque<std::function<void()>>   m_tasks;
+    uint32                              m_pending;
+    bool                                m_bQuit;
+
+    std::mutex                          m_mutex;
+    std::condition_variable             m_taskCondition;
+    std::condition_variable             m_doneCondition;
+
+    void _WorkerLoop();
+
+    // Forbid copy + copy assignment
+    TaskQueue(const TaskQueue& other)               = delete;
+    TaskQueue& operator= (const TaskQueue& other)   = delete;
+};
@@ -1,12 +1,13 @@
 #include "stdafx.h"
 #include "timer/platform_timer.h"
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb/stb_image_write.h"
-
 #include "rasterizer/rasterizer.h"
+#include "present/headless_target.h"
+#include "present/window.h"
+#include "bake/split_map_baker.h"
+#include "benchmark/benchmark.h"
 
-
+#ifdef PLATFORM_WIN32
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
     switch (msg)
@@ -26,6 +27,7 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     }
     return 0;
 }
+#endif
 
 
 class Stars3D
@@ -89,13 +91,13 @@ private:
     f32 *m_starZ;
 };
 
-int main()
+#ifdef PLATFORM_WIN32
+int RunWindowed(uint32 width, uint32 height, RasterKernel kernel, uint32 numThreads)
 {
-    uint32 width = 1024;
-    uint32 height = 1024;
-
     Window window(width, height, false, WndProc);
     Rasterizer rasterizer(window);
+    rasterizer.SetRasterKernel(kernel);
+    rasterizer.SetThreadCount(numThreads);
 
     uint64 prevTicks = OS::PlatformTimer::getTicks();
 
@@ -150,6 +152,134 @@ int main()
 
     return 0;
 }
+#endif
+
+// Renders a fixed number of frames without a display. The frame delta is fixed
+// so that two runs with the same arguments produce the same images.
+int RunHeadless(uint32 width, uint32 height, uint32 numFrames, const string& outputPrefix, RasterKernel kernel, uint32 numThreads)
+{
+    HeadlessTarget target(width, height, outputPrefix);
+    Rasterizer rasterizer(target);
+    rasterizer.SetRasterKernel(kernel);
+    rasterizer.SetThreadCount(numThreads);
+
+    Stars3D stars(4096, 64.0f, 20.0f);
+    const f32 delta = 1000.0f / 60.0f;
+
+    uint64 startTicks = OS::PlatformTimer::getTicks();
+
+    for (uint32 frame = 0; frame < numFrames; frame++)
+    {
+        rasterizer.Clear();
+        stars.UpdateAndRender(rasterizer.GetBitmap(), delta / 1000.0f);
+        rasterizer.SwapBuffers();
+    }
+
+    f64 totalMs = OS::PlatformTimer::ticksToMilliSeconds(OS::PlatformTimer::getTicks() - startTicks);
+    printf("Rendered %u frames in %fms (%fms per frame)\n", numFrames, totalMs, numFrames ? totalMs / numFrames : 0.0);
+
+    if (target.GetFailedFrameCount() != 0)
+    {
+        printf("Failed to write %llu of %u frames\n", (unsigned long long)target.GetFailedFrameCount(), numFrames);
+        return 1;
+    }
+
+    return 0;
+}
+
+int RunBake(uint32 width, uint32 height, const string& outputPrefix, uint32 numRepeats, uint32 numThreads, uint32 numIoThreads);
+int RunBenchmark(const BenchmarkSettings& settings, const string& outputPath, const string& filter);
+int RunVerify(const BenchmarkSettings& settings, const string& filter);
+
+int main(int argc, char *argv[])
+{
+    uint32 width = 1024;
+    uint32 height = 1024;
+
+    bool bHeadless = false;
+    uint32 numFrames = 60;
+    string outputPrefix = "";
+    RasterKernel kernel = RasterKernel::Auto;
+    uint32 numThreads = 0;
+    string bakePrefix = "";
+    bool bBake = false;
+    uint32 numRepeats = 1;
+    uint32 numIoThreads = 0;
+    bool bBenchmark = false;
+    bool bVerify = false;
+    string benchmarkPath = "";
+    string benchmarkFilter = "";
+    uint32 numWarmupFrames = 3;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string arg(argv[i]);
+        if (arg == "--help")
+        {
+            printf("Arguments:\n --headless             Render without a window\n --size <w> <h>         Size of the render target\n --frames <n>           Number of frames to render headless\n --output <prefix>      Write every headless frame to <prefix><frame>.png\n --kernel <name>        Triangle kernel: auto, scalar, sse2 or avx2\n --threads <n>          Raster threads, 0 uses all hardware threads\n --bake <prefix>        Bake all split maps of the head to <prefix><region>.png and exit\n --repeat <n>           Number of bakes, for throughput measurements\n --io-threads <n>       Threads encoding and writing baked images, 0 uses all hardware threads\n --benchmark <file>     Run all benchmark workloads and write the results as JSON, - prints them\n --filter <text>        Only benchmark workloads whose name contains the text\n --warmup <n>           Unmeasured frames rendered before every benchmark workload\n --verify               Check that all kernels and thread counts render the same frames and exit\n");
+            return 0;
+        }
+        else if (arg == "--headless")
+            bHeadless = true;
+        else if (arg == "--size" && i + 2 < argc)
+        {
+            width = std::stoi(argv[++i]);
+            height = std::stoi(argv[++i]);
+        }
+        else if (arg == "--frames" && i + 1 < argc)
+            numFrames = std::stoi(argv[++i]);
+        else if (arg == "--output" && i + 1 < argc)
+            outputPrefix = argv[++i];
+        else if (arg == "--kernel" && i + 1 < argc)
+        {
+            string name(argv[++i]);
+            if (name == "scalar")    kernel = RasterKernel::Scalar;
+            else if (name == "sse2") kernel = RasterKernel::SSE2;
+            else if (name == "avx2") kernel = RasterKernel::AVX2;
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+            numThreads = std::stoi(argv[++i]);
+        else if (arg == "--bake" && i + 1 < argc)
+            bBake = true, bakePrefix = argv[++i];
+        else if (arg == "--repeat" && i + 1 < argc)
+            numRepeats = std::stoi(argv[++i]);
+        else if (arg == "--io-threads" && i + 1 < argc)
+            numIoThreads = std::stoi(argv[++i]);
+        else if (arg == "--benchmark" && i + 1 < argc)
+            bBenchmark = true, benchmarkPath = argv[++i];
+        else if (arg == "--verify")
+            bVerify = true;
+        else if (arg == "--filter" && i + 1 < argc)
+            benchmarkFilter = argv[++i];
+        else if (arg == "--warmup" && i + 1 < argc)
+            numWarmupFrames = std::stoi(argv[++i]);
+    }
+
+    if (bBake)
+        return RunBake(width, height, bakePrefix, numRepeats, numThreads, numIoThreads);
+
+    if (bBenchmark || bVerify)
+    {
+        BenchmarkSettings settings;
+        settings.width = width;
+        settings.height = height;
+        settings.kernel = kernel;
+        settings.numThreads = numThreads;
+        settings.warmupFrames = numWarmupFrames;
+        settings.frames = numFrames;
+        return bVerify ? RunVerify(settings, benchmarkFilter) : RunBenchmark(settings, benchmarkPath, benchmarkFilter);
+    }
+
+#ifdef PLATFORM_WIN32
+    if (!bHeadless)
+        return RunWindowed(width, height, kernel, numThreads);
+#else
+    if (!bHeadless)
+        printf("No window backend on this platform, rendering headless.\n");
+#endif
+
+    return RunHeadless(width, height, numFrames, outputPrefix, kernel, numThreads);
+}
 
 
 
@@ -180,59 +310,305 @@ f64* pSplitMaps[NUM_REGIONS] = { arrSplitMap_BrowL, arrSplitMap_BrowR, arrSplitM
 
 void RasterizeRegions(Rasterizer& rasterizer, std::vector<int> regions, int nDrawMode)
 {
-    uint32 width = rasterizer.GetBitmap().GetWidth();
-    uint32 height = rasterizer.GetBitmap().GetHeight();
-    for (uint16 idx = 0; idx < PROTOS_HEAD_ICOUNT; idx += 3)
+    f32 width = (f32)rasterizer.GetBitmap().GetWidth();
+    f32 height = (f32)rasterizer.GetBitmap().GetHeight();
+
+    // Every vertex is scaled to the bitmap and shaded with the summed region weights once
+    auto shader = [&](uint32 v)
     {
-        uint16 v0 = arrProtosIndicesHead[idx];
-        uint16 v1 = arrProtosIndicesHead[idx + 1];
-        uint16 v2 = arrProtosIndicesHead[idx + 2];
+        f64 fSplitVal = 0.0;
+        for (int reg : regions)
+            fSplitVal += pSplitMaps[reg][v];
 
-        Point2D p1{ arrProtosTexCoordsHead[2 * v0], arrProtosTexCoordsHead[2 * v0 + 1] };
-        Point2D p2{ arrProtosTexCoordsHead[2 * v1], arrProtosTexCoordsHead[2 * v1 + 1] };
-        Point2D p3{ arrProtosTexCoordsHead[2 * v2], arrProtosTexCoordsHead[2 * v2 + 1] };
+        uint8 col = uint8(std::min(fSplitVal, 1.0) * 255);
 
-        Point2D pC1{ p1.x * width, p1.y * height };
-        Point2D pC2{ p2.x * width, p2.y * height };
-        Point2D pC3{ p3.x * width, p3.y * height };
+        Vertex2D vertex;
+        vertex.position = { arrProtosTexCoordsHead[2 * v] * width, arrProtosTexCoordsHead[2 * v + 1] * height };
+        vertex.color = ColorB{ col, col, col, col };
+        vertex.bCulled = col == 0;
+        return vertex;
+    };
 
-        f64 fSplitVal0 = 0.0f;
-        f64 fSplitVal1 = 0.0f;
-        f64 fSplitVal2 = 0.0f;
-        for (int reg : regions)
+    std::vector<Vertex2D> vertices;
+    rasterizer.ProcessVertices(PROTOS_HEAD_VCOUNT, shader, vertices);
+
+    if (nDrawMode == 0 || nDrawMode == 1)
+        rasterizer.DrawIndexed(vertices.data(), PROTOS_HEAD_VCOUNT, arrProtosIndicesHead, PROTOS_HEAD_ICOUNT, PrimitiveType::Triangles);
+
+    // Edges shared by two triangles are only drawn once
+    if (nDrawMode == 1 || nDrawMode == 2)
+        rasterizer.DrawLines(vertices.data(), PROTOS_HEAD_VCOUNT, arrProtosIndicesHead, PROTOS_HEAD_ICOUNT, PrimitiveType::TriangleEdges);
+
+    if (nDrawMode == 3)
+        rasterizer.DrawIndexed(vertices.data(), PROTOS_HEAD_VCOUNT, arrProtosIndicesHead, PROTOS_HEAD_ICOUNT, PrimitiveType::Points);
+}
+
+// All regions plus the symmetrical pairs, in the order of the region defines
+const std::vector<BakeLayer> g_bakeLayers =
+{
+    { "BrowL",    { 0 } },
+    { "BrowR",    { 1 } },
+    { "EyeL",     { 2 } },
+    { "EyeR",     { 3 } },
+    { "Nose",     { 4 } },
+    { "EarL",     { 5 } },
+    { "EarR",     { 6 } },
+    { "CheekL",   { 7 } },
+    { "CheekR",   { 8 } },
+    { "Mouth",    { 9 } },
+    { "Jaw",      { 10 } },
+    { "Neckhead", { 11 } },
+    { "Brows",    { 0, 1 } },
+    { "Eyes",     { 2, 3 } },
+    { "Ears",     { 5, 6 } },
+    { "Cheeks",   { 7, 8 } },
+};
+
+int RunBake(uint32 width, uint32 height, const string& outputPrefix, uint32 numRepeats, uint32 numThreads, uint32 numIoThreads)
+{
+    if (numRepeats == 0)
+    {
+        printf("--repeat must be at least 1\n");
+        return 1;
+    }
+
+    SplitMapMesh<uint16> mesh{ arrProtosTexCoordsHead, PROTOS_HEAD_VCOUNT, arrProtosIndicesHead, PROTOS_HEAD_ICOUNT, pSplitMaps, NUM_REGIONS };
+    SplitMapBaker baker(width, height, numThreads, numIoThreads);
+
+    uint64 startTicks = OS::PlatformTimer::getTicks();
+
+    for (uint32 i = 0; i < numRepeats; i++)
+    {
+        // Repeated bakes must not write the same files concurrently
+        string prefix = numRepeats > 1 ? outputPrefix + std::to_string(i) + "_" : outputPrefix;
+        baker.Bake(mesh, g_bakeLayers, prefix);
+    }
+    baker.Flush();
+
+    f64 totalSeconds = OS::PlatformTimer::ticksToSeconds(OS::PlatformTimer::getTicks() - startTicks);
+    BakeStats stats = baker.GetStats();
+
+    // Only images which made it to disk count towards the throughput
+    const uint32 writtenImages = stats.images - stats.failedImages;
+
+    printf("Baked %u x %u images of %ux%u in %fs\n", stats.bakes, (uint32)g_bakeLayers.size(), width, height, totalSeconds);
+    printf("  raster: %fms per bake\n", OS::PlatformTimer::ticksToMilliSeconds(stats.rasterTicks) / stats.bakes);
+    printf("  encode: %fms per image (%.1f MB written)\n", OS::PlatformTimer::ticksToMilliSeconds(stats.encodeTicks) / stats.images, stats.bytesWritten / (1024.0 * 1024.0));
+    printf("  throughput: %.2f bakes/s, %.2f images/s, %.2f Mpixels/s\n",
+           stats.bakes / totalSeconds, writtenImages / totalSeconds, (f64)writtenImages * width * height / totalSeconds / 1000000.0);
+
+    if (stats.failedImages != 0)
+    {
+        printf("Failed to write %u of %u images\n", stats.failedImages, stats.images);
+        return 1;
+    }
+
+    return 0;
+}
+
+// Random triangles with legs of the given length, together covering the target about
+// four times. The same seed always gives the same triangles.
+std::vector<Triangle2D> MakeFillRateTriangles(uint32 width, uint32 height, f32 size, uint32 seed)
+{
+    const uint32 count = std::min((uint32)(4.0 * width * height / (size * size * 0.5)), 200000u);
+
+    std::vector<Triangle2D> triangles;
+    triangles.reserve(count);
+
+    srand(seed);
+    auto random = [](f32 max) { return rand() / (f32)RAND_MAX * max; };
+    for (uint32 i = 0; i < count; i++)
+    {
+        f32 x = random(width - size);
+        f32 y = random(height - size);
+        ColorB col = ColorB(rand() & 0xff, rand() & 0xff, rand() & 0xff);
+        triangles.push_back({ { x, y }, { x + size, y }, { x, y + size }, col, col * 0.5f, col * 0.25f });
+    }
+    return triangles;
+}
+
+// Layers of random triangles covering about a quarter of the target each, sorted front to
+// back. Layer l lies at depth (l + 0.5) / numLayers with a w growing with the depth.
+std::vector<Triangle3D> MakeDepthLayers(uint32 width, uint32 height, uint32 numLayers, uint32 trianglesPerLayer, uint32 seed)
+{
+    std::vector<Triangle3D> triangles;
+    triangles.reserve(numLayers * trianglesPerLayer);
+
+    srand(seed);
+    auto random = [](f32 max) { return rand() / (f32)RAND_MAX * max; };
+    for (uint32 l = 0; l < numLayers; l++)
+    {
+        const f32 z = (l + 0.5f) / numLayers;
+        const f32 w = 1.0f + 3.0f * z;
+        for (uint32 i = 0; i < trianglesPerLayer; i++)
         {
-            fSplitVal0 += pSplitMaps[reg][v0];
-            fSplitVal1 += pSplitMaps[reg][v1];
-            fSplitVal2 += pSplitMaps[reg][v2];
+            f32 x = random(width * 0.5f), y = random(height * 0.5f);
+            ColorB col = ColorB(rand() & 0xff, rand() & 0xff, rand() & 0xff);
+            triangles.push_back({ { x, y, z }, { x + width * 0.75f, y, z }, { x, y + height * 0.75f, z }, w, w, w, col, col * 0.5f, col * 0.25f });
         }
+    }
+    return triangles;
+}
 
-        unsigned char col0 = unsigned char(fSplitVal0 * 255);
-        unsigned char col1 = unsigned char(fSplitVal1 * 255);
-        unsigned char col2 = unsigned char(fSplitVal2 * 255);
+// Random lines with both end points on pixels inside of the target
+std::vector<std::pair<Point2D, Point2D>> MakeLines(uint32 width, uint32 height, uint32 count, f32 maxLength, uint32 seed)
+{
+    std::vector<std::pair<Point2D, Point2D>> lines;
+    lines.reserve(count);
 
-        if (col0 == 0 && col1 == 0 && col2 == 0)
-            continue;
+    srand(seed);
+    auto random = [](f32 min, f32 max) { return floorf(min + rand() / (f32)RAND_MAX * (max - min)); };
+    for (uint32 i = 0; i < count; i++)
+    {
+        Point2D p0{ random(0.0f, width - 1.0f), random(0.0f, height - 1.0f) };
+        Point2D p1{ std::min(std::max(p0.x + random(-maxLength, maxLength), 0.0f), width - 1.0f),
+                    std::min(std::max(p0.y + random(-maxLength, maxLength), 0.0f), height - 1.0f) };
+        lines.push_back({ p0, p1 });
+    }
+    return lines;
+}
 
-        ColorB c0{ col0, col0, col0, col0 };
-        ColorB c1{ col1, col1, col1, col1 };
-        ColorB c2{ col2, col2, col2, col2 };
+// Calls visit for every workload which draws the same frame every time, independent of
+// the frame number and of what was drawn before
+void ForEachStaticWorkload(uint32 width, uint32 height, const std::function<void(const string& name, const BenchmarkFrameFunc& drawFrame)>& visit)
+{
+    const char* drawModes[] = { "head_fill", "head_fill_wire", "head_wire", "head_points" };
+    const std::vector<int> allRegions = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    for (int nDrawMode = 0; nDrawMode < 4; nDrawMode++)
+        visit(drawModes[nDrawMode], [&](Rasterizer& rasterizer, uint32) { RasterizeRegions(rasterizer, allRegions, nDrawMode); });
 
-        if (nDrawMode == 0 || nDrawMode == 1)
-            rasterizer.FillTriangle({ pC1, pC2, pC3, c0, c1, c2 });
+    for (f32 size : { 8.0f, 32.0f, 128.0f, 512.0f })
+    {
+        std::vector<Triangle2D> triangles = MakeFillRateTriangles(width, height, size, 2);
+        visit("fill_" + std::to_string((int)size), [&](Rasterizer& rasterizer, uint32)
+        {
+            PROFILE_ZONE("Triangles");
+            for (const Triangle2D& t : triangles)
+                rasterizer.FillTriangle(t);
+        });
+    }
 
-        if (nDrawMode == 1 || nDrawMode == 2)
+    // Front to back lets hi-z reject most of the layers, back to front passes all of them
+    std::vector<Triangle3D> layers = MakeDepthLayers(width, height, 32, 8, 4);
+    visit("depth_front", [&](Rasterizer& rasterizer, uint32)
+    {
+        rasterizer.EnableDepthBuffer(true);
+        PROFILE_ZONE("Triangles");
+        for (const Triangle3D& t : layers)
+            rasterizer.FillTriangle3D(t);
+    });
+    visit("depth_back", [&](Rasterizer& rasterizer, uint32)
+    {
+        rasterizer.EnableDepthBuffer(true);
+        PROFILE_ZONE("Triangles");
+        for (auto it = layers.rbegin(); it != layers.rend(); ++it)
+            rasterizer.FillTriangle3D(*it);
+    });
+}
+
+int RunBenchmark(const BenchmarkSettings& settings, const string& outputPath, const string& filter)
+{
+    Benchmark benchmark(settings);
+    const f32 delta = 1.0f / 60.0f;
+
+    // Keep stdout clean when the JSON goes there
+    FILE* pLog = outputPath == "-" ? stderr : stdout;
+
+    auto run = [&](const string& name, const BenchmarkFrameFunc& drawFrame)
+    {
+        if (name.find(filter) == string::npos)
+            return;
+
+        const BenchmarkResult& result = benchmark.Run(name, drawFrame);
+        fprintf(pLog, "%-16s p50 %8.3fms  p99 %8.3fms  %9.2f Mpixels/s  %9.2f Mfilled/s  %7.3f Mtriangles/s\n", name.c_str(), result.p50Ms, result.p99Ms,
+               result.pixels / (result.totalMs * 1000.0), result.primitives.triangleArea / (result.totalMs * 1000.0),
+               result.primitives.triangles / (result.totalMs * 1000.0));
+        if (result.bDepth)
+            fprintf(pLog, "%-16s hi-z rejected %llu tiles (%llu pixels), depth test rejected %llu fragments\n", "", (unsigned long long)result.depth.tilesRejected,
+                    (unsigned long long)result.depth.pixelsRejected, (unsigned long long)result.depth.fragmentsRejected);
+    };
+
+    for (int numStars : { 1024, 4096, 16384, 65536 })
+    {
+        srand(1);
+        Stars3D stars(numStars, 64.0f, 20.0f);
+        run("stars_" + std::to_string(numStars), [&](Rasterizer& rasterizer, uint32) { stars.UpdateAndRender(rasterizer.GetBitmap(), delta); });
+    }
+
+    ForEachStaticWorkload(settings.width, settings.height, run);
+
+    struct LineScene { const char* name; uint32 count; f32 maxLength; LineStyle style; };
+    const LineScene lineScenes[] =
+    {
+        { "lines_short",    50000, 16.0f,   LineStyle() },
+        { "lines_long",     2000,  4096.0f, LineStyle() },
+        { "lines_long_aa",  2000,  4096.0f, LineStyle{ 1.0f, true } },
+        { "lines_wide",     2000,  4096.0f, LineStyle{ 4.0f, false } },
+        { "lines_wide_aa",  2000,  4096.0f, LineStyle{ 4.0f, true } },
+    };
+    for (const LineScene& scene : lineScenes)
+    {
+        std::vector<std::pair<Point2D, Point2D>> lines = MakeLines(settings.width, settings.height, scene.count, scene.maxLength, 3);
+        run(scene.name, [&](Rasterizer& rasterizer, uint32)
         {
-            rasterizer.DrawLine(pC1, pC2, c0);
-            rasterizer.DrawLine(pC2, pC3, c1);
-            rasterizer.DrawLine(pC3, pC1, c2);
-        }
-        if (nDrawMode == 3)
+            PROFILE_ZONE("Lines");
+            for (const auto& line : lines)
+                rasterizer.DrawLine(line.first, line.second, ColorB(0xffffffff), scene.style);
+        });
+    }
+
+    string json = benchmark.ToJson();
+    if (outputPath == "-")
+    {
+        printf("%s", json.c_str());
+        return 0;
+    }
+
+    FILE* pFile = nullptr;
+#ifdef PLATFORM_WIN32
+    if (fopen_s(&pFile, outputPath.c_str(), "wb") != 0)
+        pFile = nullptr;
+#else
+    pFile = fopen(outputPath.c_str(), "wb");
+#endif
+    if (!pFile)
+    {
+        printf("Failed to write %s\n", outputPath.c_str());
+        return 1;
+    }
+
+    fwrite(json.data(), 1, json.size(), pFile);
+    fclose(pFile);
+    return 0;
+}
+
+// Renders every static workload with all kernels and several thread counts. Binning and
+// the SIMD kernels must not change a single pixel, so all frames of a workload have to
+// match. Returns 1 if any of them differ.
+int RunVerify(const BenchmarkSettings& settings, const string& filter)
+{
+    Benchmark benchmark(settings);
+    const std::vector<uint32> threadCounts = { 1, 3, 8 };
+    bool bAllMatch = true;
+
+    ForEachStaticWorkload(settings.width, settings.height, [&](const string& name, const BenchmarkFrameFunc& drawFrame)
+    {
+        if (name.find(filter) == string::npos)
+            return;
+
+        std::vector<FrameHash> hashes = benchmark.HashFrames(drawFrame, threadCounts);
+        bool bMatch = std::all_of(hashes.begin(), hashes.end(), [&](const FrameHash& h) { return h.hash == hashes[0].hash; });
+        printf("%-16s %s, %u configurations\n", name.c_str(), bMatch ? "identical" : "DIFFERENT", (uint32)hashes.size());
+
+        if (!bMatch)
         {
-            rasterizer.GetBitmap().SetPixel((uint32)pC1.x, (uint32)pC1.y, c0);
-            rasterizer.GetBitmap().SetPixel((uint32)pC2.x, (uint32)pC2.y, c1);
-            rasterizer.GetBitmap().SetPixel((uint32)pC3.x, (uint32)pC3.y, c2);
+            for (const FrameHash& h : hashes)
+                printf("  %-6s %2u threads  %016llx\n", GetRasterKernelName(h.kernel), h.threads, (unsigned long long)h.hash);
+            bAllMatch = false;
         }
-    }
+    });
+
+    return bAllMatch ? 0 : 1;
 }
 
 //int main(int argc, char *argv[])
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "present_target.h"
+#include "stb/stb_image_write.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Present target without any display. If an output prefix is given, every frame is
+// written to "<prefix><frame>.png". With bKeepFrame the last presented frame is also
+// copied into memory, which costs a full frame copy per Present().
+////////////////////////////////////////////////////////////////////////////////////////////
+class HeadlessTarget : public IPresentTarget
+{
+public:
+    HeadlessTarget(uint32 width, uint32 height, const string& outputPrefix = "", bool bKeepFrame = false)
+        : m_width(width), m_height(height), m_outputPrefix(outputPrefix), m_bKeepFrame(bKeepFrame), m_frameCount(0), m_failedFrames(0)
+    {
+    }
+
+    uint32 GetWidth() const override { return m_width; }
+    uint32 GetHeight() const override { return m_height; }
+
+    void Present(const Bitmap& bitmap) override
+    {
+        if (m_bKeepFrame)
+        {
+            const ColorB* pPixels = (const ColorB*)bitmap.GetData();
+            m_frame.assign(pPixels, pPixels + m_width * m_height);
+        }
+
+        if (!m_outputPrefix.empty())
+        {
+            string path = m_outputPrefix + std::to_string(m_frameCount) + ".png";
+            if (!SaveToFile(path, bitmap))
+            {
+                printf("Failed to write %s\n", path.c_str());
+                m_failedFrames++;
+            }
+        }
+
+        m_frameCount++;
+    }
+
+    // The conversion buffer is kept, so saving every frame does not allocate
+    bool SaveToFile(const string& path, const Bitmap& bitmap)
+    {
+        m_rgb.resize(bitmap.GetPixelCount() * 3);
+        bitmap.GetDataRGB(m_rgb.data());
+
+        int row = m_width * 3;
+        return stbi_write_png(path.c_str(), m_width, m_height, 3, m_rgb.data(), row) != 0;
+    }
+
+    // Empty unless the target keeps its frames
+    inline const std::vector<ColorB>& GetFrame() const { return m_frame; }
+    inline uint64 GetFrameCount() const { return m_frameCount; }
+    inline uint64 GetFailedFrameCount() const { return m_failedFrames; }
+
+private:
+    uint32              m_width;
+    uint32              m_height;
+    string              m_outputPrefix;
+    bool                m_bKeepFrame;
+    uint64              m_frameCount;
+    uint64              m_failedFrames;     // Frames which could not be written
+    std::vector<ColorB> m_frame;
+    std::vector<uint8>  m_rgb;
+};
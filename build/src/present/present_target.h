@@ -0,0 +1,18 @@
+#pragma once
+
+#include "rasterizer/bitmap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Destination for finished frames. The rasterizer only ever talks to this interface,
+// so it does not care whether a frame ends up on screen, in memory or on disk.
+////////////////////////////////////////////////////////////////////////////////////////////
+class IPresentTarget
+{
+public:
+    virtual ~IPresentTarget() = default;
+
+    virtual uint32 GetWidth() const = 0;
+    virtual uint32 GetHeight() const = 0;
+
+    virtual void Present(const Bitmap& bitmap) = 0;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#ifdef PLATFORM_WIN32
+
+#include "present_target.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+class Window : public IPresentTarget
+{
+public:
+    Window(uint32 width, uint32 height, bool bCenter, WNDPROC wndProc)
+        : m_width(width), m_height(height)
+    {
+        LPCWSTR strClassName = L"Software Rasterizer";
+        LPCWSTR strTitle = L"Software Rasterizer";
+
+        //Step 1: Registering the Window Class
+        WNDCLASSEX wc;
+        wc.cbSize = sizeof(WNDCLASSEX);
+        wc.style = 0;
+        wc.lpfnWndProc = wndProc;
+        wc.cbClsExtra = 0;
+        wc.cbWndExtra = 0;
+        wc.hInstance = m_hInstance;
+        wc.hIcon = LoadIcon(NULL, IDI_APPLICATION);
+        wc.hCursor = LoadCursor(NULL, IDC_ARROW);
+        wc.hbrBackground = NULL;
+        wc.lpszMenuName = NULL;
+        wc.lpszClassName = strClassName;
+        wc.hIconSm = LoadIcon(NULL, IDI_APPLICATION);
+        RegisterClassEx(&wc);
+
+        UINT x = CW_USEDEFAULT;
+        UINT y = CW_USEDEFAULT;
+        if (bCenter)
+        {
+            UINT screenResX = GetSystemMetrics(SM_CXSCREEN);
+            UINT screenResY = GetSystemMetrics(SM_CYSCREEN);
+            x = (UINT)(screenResX * 0.5f - (width * 0.5f));
+            y = (UINT)(screenResY * 0.5f - (height * 0.5f));
+        }
+        DWORD windowStyle = WS_OVERLAPPEDWINDOW;
+
+        // Calculate real window size (with borders)
+        RECT r{ 0, 0, (LONG)width, (LONG)height };
+        AdjustWindowRect(&r, windowStyle, FALSE);
+        UINT w = r.right - r.left;
+        UINT h = r.bottom - r.top;
+
+        m_hwnd = CreateWindowEx(WS_EX_CLIENTEDGE, strClassName, strTitle, windowStyle, x, y, w, h, NULL, NULL, m_hInstance, NULL);
+
+        ShowWindow(m_hwnd, SW_SHOW);
+        UpdateWindow(m_hwnd);
+
+        m_hdc = GetDC(m_hwnd);
+    }
+
+    uint32 GetWidth() const override { return m_width; }
+    uint32 GetHeight() const override { return m_height; }
+
+    void SetTitle(const wchar_t* newTitle, ...)
+    {
+        WCHAR buffer[256]{};
+        va_list args;
+        va_start(args, newTitle);
+        vswprintf(buffer, 256, newTitle, args);
+        va_end(args);
+        SetWindowText(m_hwnd, buffer);
+    }
+
+    void SwapBuffers(const void* pPixels) const
+    {
+        HBITMAP bitmap = CreateBitmap(m_width, m_height, 1, 32, (void*)pPixels);
+
+        HDC src = CreateCompatibleDC(m_hdc);
+        SelectObject(src, bitmap);
+
+        BitBlt(m_hdc, 0, 0, m_width, m_height, src, 0, 0, SRCCOPY);
+
+        DeleteDC(src);
+        DeleteObject(bitmap);
+    }
+
+    void Present(const Bitmap& bitmap) override
+    {
+        SwapBuffers(bitmap.GetData());
+    }
+
+    bool HandleMessages() const
+    {
+        bool bKeepRunning = true;
+
+        MSG msg;
+        while (PeekMessage(&msg, NULL, NULL, NULL, PM_REMOVE))
+        {
+            if (msg.message == WM_QUIT)
+                bKeepRunning = false;
+
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+
+        return bKeepRunning;
+    }
+
+private:
+    uint32    m_width;
+    uint32    m_height;
+    HWND      m_hwnd;
+    HINSTANCE m_hInstance;
+    HDC       m_hdc;
+};
+
+#endif // PLATFORM_WIN32
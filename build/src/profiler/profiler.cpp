@@ -0,0 +1,67 @@
+#include <stdafx.h>
+#include "profiler.h"
+
+namespace
+{
+    struct ProfilerState
+    {
+        std::vector<ProfileNode>    nodes;
+        uint32                      current = 0;
+
+        ProfilerState() { Reset(); }
+
+        void Reset()
+        {
+            nodes.clear();
+            nodes.push_back({ "root", PROFILE_NODE_NONE, PROFILE_NODE_NONE, PROFILE_NODE_NONE, 0, 0 });
+            current = 0;
+        }
+    };
+
+    thread_local ProfilerState s_state;
+}
+
+//----------------------------------------------------------------------
+uint32 Profiler::BeginZone(const char* name)
+{
+    ProfilerState& state = s_state;
+
+    uint32 lastChild = PROFILE_NODE_NONE;
+    for (uint32 child = state.nodes[state.current].firstChild; child != PROFILE_NODE_NONE; child = state.nodes[child].nextSibling)
+    {
+        if (state.nodes[child].name == name)
+            return state.current = child;
+        lastChild = child;
+    }
+
+    uint32 node = (uint32)state.nodes.size();
+    state.nodes.push_back({ name, state.current, PROFILE_NODE_NONE, PROFILE_NODE_NONE, 0, 0 });
+    if (lastChild == PROFILE_NODE_NONE)
+        state.nodes[state.current].firstChild = node;
+    else
+        state.nodes[lastChild].nextSibling = node;
+
+    return state.current = node;
+}
+
+//----------------------------------------------------------------------
+void Profiler::EndZone(uint32 node, uint64 ticks)
+{
+    ProfilerState& state = s_state;
+
+    state.nodes[node].calls++;
+    state.nodes[node].ticks += ticks;
+    state.current = state.nodes[node].parent;
+}
+
+//----------------------------------------------------------------------
+void Profiler::Reset()
+{
+    s_state.Reset();
+}
+
+//----------------------------------------------------------------------
+const std::vector<ProfileNode>& Profiler::GetNodes()
+{
+    return s_state.nodes;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "timer/platform_timer.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Accumulated time of one zone at one place in the zone hierarchy. The same name opened
+// under different parents gives different nodes.
+////////////////////////////////////////////////////////////////////////////////////////////
+struct ProfileNode
+{
+    const char* name;
+    uint32      parent;
+    uint32      firstChild;
+    uint32      nextSibling;
+    uint64      calls;
+    uint64      ticks;      // Inclusive, children are part of it
+};
+
+#define PROFILE_NODE_NONE UINT32_MAX
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Hierarchical zone profiler. Every thread records into its own tree, reports only cover
+// the thread asking for them. Zone names are looked up by pointer, so they must be string
+// literals. Opening a zone is a pointer compare per sibling plus one timer query.
+////////////////////////////////////////////////////////////////////////////////////////////
+class Profiler
+{
+public:
+    // Returns the node of the zone, which becomes the parent of zones opened until EndZone
+    static uint32 BeginZone(const char* name);
+    static void EndZone(uint32 node, uint64 ticks);
+
+    // Drops all nodes of the calling thread. Must not be called while a zone is open.
+    static void Reset();
+
+    // Node 0 is the root which holds no time, its children are the outermost zones
+    static const std::vector<ProfileNode>& GetNodes();
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name)
+    {
+        m_node = Profiler::BeginZone(name);
+        m_startTicks = OS::PlatformTimer::getTicks();
+    }
+    ~ProfileZone()
+    {
+        Profiler::EndZone(m_node, OS::PlatformTimer::getTicks() - m_startTicks);
+    }
+
+private:
+    uint32 m_node;
+    uint64 m_startTicks;
+
+    ProfileZone(const ProfileZone& other)               = delete;
+    ProfileZone& operator=(const ProfileZone& other)    = delete;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// Times the rest of the enclosing scope. Compiled out with DISABLE_PROFILER.
+#ifdef DISABLE_PROFILER
+  #define PROFILE_ZONE(name)
+#else
+  #define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#endif
+
+// Zone around the work of a single primitive. Two timer queries per primitive cost about
+// as much as setting up a small triangle, so they are only compiled in with
+// PROFILE_PRIMITIVES. Otherwise primitives are only timed per batch.
+#if defined(PROFILE_PRIMITIVES) && !defined(DISABLE_PROFILER)
+  #define PROFILE_PRIMITIVE_ZONE(name) PROFILE_ZONE(name)
+#else
+  #define PROFILE_PRIMITIVE_ZONE(name)
+#endif
\ No newline at end of file
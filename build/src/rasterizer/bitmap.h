@@ -0,0 +1,176 @@
+#pragma once
+
+#include "framebuffer_ops.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct ColorB
+{
+    unsigned char b, g, r, a;
+
+public:
+    ColorB()
+        : b(0), g(0), r(0), a(0)
+    {
+    }
+
+    ColorB(unsigned char b, unsigned char g, unsigned char r, unsigned char a = 0xff)
+        : b(b), g(g), r(r), a(a)
+    {
+    }
+
+    ColorB(int val)
+    {
+        b = (val & 0x000000ff) >> 0;
+        g = (val & 0x0000ff00) >> 8;
+        r = (val & 0x00ff0000) >> 16;
+        a = (val & 0xff000000) >> 24;
+    }
+
+    // Scales all channels, the result is rounded and clamped to [0, 255]
+    ColorB operator*(f32 val) const
+    {
+        return ColorB{ Scale(b, val), Scale(g, val), Scale(r, val), Scale(a, val) };
+    }
+
+    // Adds all channels, saturating at 255
+    ColorB operator+(ColorB c) const
+    {
+        return ColorB{ Add(b, c.b), Add(g, c.g), Add(r, c.r), Add(a, c.a) };
+    }
+
+    ColorB& operator+=(ColorB c)
+    {
+        *this = *this + c;
+        return *this;
+    }
+
+private:
+    static inline unsigned char Scale(unsigned char c, f32 val)
+    {
+        f32 scaled = c * val + 0.5f;
+        return uint8(scaled <= 0.0f ? 0.0f : (scaled >= 255.0f ? 255.0f : scaled));
+    }
+
+    static inline unsigned char Add(unsigned char c0, unsigned char c1)
+    {
+        uint32 sum = (uint32)c0 + c1;
+        return uint8(sum > 255 ? 255 : sum);
+    }
+};
+
+// Returns round(c0 * c1 / 255) without a division
+inline uint32 MulDiv255(uint32 c0, uint32 c1)
+{
+    uint32 x = c0 * c1 + 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar reference of the blend modes, BlendPixels() produces the same colors
+////////////////////////////////////////////////////////////////////////////////////////////
+inline ColorB BlendColor(ColorB dst, ColorB src, BlendMode mode)
+{
+    auto over = [](uint32 s, uint32 d, uint32 invA) { return uint8(std::min(s + MulDiv255(d, invA), 255u)); };
+
+    const uint32 invA = 255 - src.a;
+    switch (mode)
+    {
+    case BlendMode::Replace:
+        return src;
+    case BlendMode::Alpha:
+        return ColorB{ over(MulDiv255(src.b, src.a), dst.b, invA), over(MulDiv255(src.g, src.a), dst.g, invA),
+                       over(MulDiv255(src.r, src.a), dst.r, invA), over(src.a, dst.a, invA) };
+    case BlendMode::Premultiplied:
+        return ColorB{ over(src.b, dst.b, invA), over(src.g, dst.g, invA), over(src.r, dst.r, invA), over(src.a, dst.a, invA) };
+    case BlendMode::Additive:
+        return dst + src;
+    case BlendMode::Multiply:
+        return ColorB{ uint8(MulDiv255(dst.b, src.b)), uint8(MulDiv255(dst.g, src.g)), uint8(MulDiv255(dst.r, src.r)), uint8(MulDiv255(dst.a, src.a)) };
+    }
+    return dst;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Pixel memory is aligned to cache lines, so SIMD loads and stores of a row never split one
+////////////////////////////////////////////////////////////////////////////////////////////
+#define BITMAP_ALIGNMENT 64
+
+inline void* AlignedAlloc(size_t size, size_t alignment)
+{
+#ifdef PLATFORM_WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+inline void AlignedFree(void* pMemory)
+{
+#ifdef PLATFORM_WIN32
+    _aligned_free(pMemory);
+#else
+    free(pMemory);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+class Bitmap
+{
+public:
+    Bitmap(uint32 width, uint32 height)
+        : m_width(width), m_height(height)
+    {
+        m_pPixels = (ColorB*)AlignedAlloc(GetPixelCount() * sizeof(ColorB), BITMAP_ALIGNMENT);
+        Clear();
+    }
+    ~Bitmap() { AlignedFree(m_pPixels); }
+
+    inline void Clear() { FillPixels(m_pPixels, GetPixelCount(), ColorB()); }
+    inline void Clear(ColorB col) { FillPixels(m_pPixels, GetPixelCount(), col); }
+
+    inline void BlendPixel(uint32 x, uint32 y, ColorB col, BlendMode mode = BlendMode::Alpha)
+    {
+        int index = y * m_width + x;
+        m_pPixels[index] = BlendColor(m_pPixels[index], col, mode);
+    }
+
+    // Blends count pixels of pSrc into the row y starting at x
+    inline void BlendSpan(uint32 x, uint32 y, const ColorB* pSrc, uint32 count, BlendMode mode = BlendMode::Alpha)
+    {
+        BlendPixels(GetRow(y) + x, pSrc, count, mode);
+    }
+
+    inline void SetPixel(uint32 x, uint32 y, ColorB col)
+    {
+        int index = y * m_width + x;
+        m_pPixels[index] = col;
+    }
+
+    inline uint32 GetWidth() const { return m_width; }
+    inline uint32 GetHeight() const { return m_height; }
+    inline void* GetData() const { return m_pPixels; }
+    inline ColorB* GetRow(uint32 y) const { return m_pPixels + y * m_width; }
+    inline size_t GetPixelCount() const { return (size_t)m_width * m_height; }
+
+    // Converts all pixels into a caller buffer of 3, 4 or 1 bytes per pixel
+    inline void GetDataRGB(uint8* pDst) const { ConvertToRGB(m_pPixels, GetPixelCount(), pDst); }
+    inline void GetDataRGBA(uint8* pDst) const { ConvertToRGBA(m_pPixels, GetPixelCount(), pDst); }
+    inline void GetDataGray(uint8* pDst) const { ConvertToGray(m_pPixels, GetPixelCount(), pDst); }
+
+    std::vector<char> GetDataRGB() const
+    {
+        std::vector<char> pPixels(GetPixelCount() * 3);
+        GetDataRGB((uint8*)pPixels.data());
+        return pPixels;
+    }
+
+private:
+    uint32  m_width;
+    uint32  m_height;
+    ColorB *m_pPixels;
+
+    // Forbid copy, the bitmap owns its pixel memory
+    Bitmap(const Bitmap& other)             = delete;
+    Bitmap& operator=(const Bitmap& other)  = delete;
+};
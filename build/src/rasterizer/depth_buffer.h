@@ -0,0 +1,108 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Size in pixels of the tiles the hierarchical depth buffer tracks the depth range of.
+// Must divide TILE_SIZE, so a hi-z tile is never shared by two raster threads.
+////////////////////////////////////////////////////////////////////////////////////////////
+#define HIZ_TILE_SIZE 8
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Float depth buffer with a smaller depth is closer. Next to the depth of every pixel it
+// keeps the min and max depth of every hi-z tile, which lets the rasterizer reject
+// occluded blocks and skip the depth test of blocks in front of everything.
+////////////////////////////////////////////////////////////////////////////////////////////
+class DepthBuffer
+{
+public:
+    DepthBuffer(uint32 width, uint32 height)
+        : m_width(width), m_height(height)
+    {
+        m_tilesX = (width + HIZ_TILE_SIZE - 1) / HIZ_TILE_SIZE;
+        m_tilesY = (height + HIZ_TILE_SIZE - 1) / HIZ_TILE_SIZE;
+        m_pDepth = (f32*)malloc((size_t)m_width * m_height * sizeof(f32));
+        m_pTileMin = (f32*)malloc((size_t)m_tilesX * m_tilesY * sizeof(f32));
+        m_pTileMax = (f32*)malloc((size_t)m_tilesX * m_tilesY * sizeof(f32));
+        Clear();
+    }
+    ~DepthBuffer()
+    {
+        free(m_pDepth);
+        free(m_pTileMin);
+        free(m_pTileMax);
+    }
+
+    void Clear(f32 depth = 1.0f)
+    {
+        std::fill(m_pDepth, m_pDepth + (size_t)m_width * m_height, depth);
+        std::fill(m_pTileMin, m_pTileMin + (size_t)m_tilesX * m_tilesY, depth);
+        std::fill(m_pTileMax, m_pTileMax + (size_t)m_tilesX * m_tilesY, depth);
+    }
+
+    inline f32* GetRow(uint32 y) const { return m_pDepth + (size_t)y * m_width; }
+    inline f32 GetDepth(uint32 x, uint32 y) const { return m_pDepth[(size_t)y * m_width + x]; }
+
+    inline f32 GetTileMin(uint32 tileX, uint32 tileY) const { return m_pTileMin[tileY * m_tilesX + tileX]; }
+    inline f32 GetTileMax(uint32 tileX, uint32 tileY) const { return m_pTileMax[tileY * m_tilesX + tileX]; }
+
+    // Recomputes the depth range of a tile after depth values in it were written
+    void UpdateTile(uint32 tileX, uint32 tileY)
+    {
+        uint32 x0 = tileX * HIZ_TILE_SIZE, x1 = std::min(x0 + HIZ_TILE_SIZE, m_width);
+        uint32 y0 = tileY * HIZ_TILE_SIZE, y1 = std::min(y0 + HIZ_TILE_SIZE, m_height);
+
+        f32 minDepth = GetDepth(x0, y0);
+        f32 maxDepth = minDepth;
+        for (uint32 y = y0; y < y1; y++)
+        {
+            const f32* pRow = GetRow(y);
+            for (uint32 x = x0; x < x1; x++)
+            {
+                minDepth = std::min(minDepth, pRow[x]);
+                maxDepth = std::max(maxDepth, pRow[x]);
+            }
+        }
+
+        m_pTileMin[tileY * m_tilesX + tileX] = minDepth;
+        m_pTileMax[tileY * m_tilesX + tileX] = maxDepth;
+    }
+
+    inline uint32 GetWidth() const { return m_width; }
+    inline uint32 GetHeight() const { return m_height; }
+
+private:
+    uint32  m_width;
+    uint32  m_height;
+    uint32  m_tilesX;
+    uint32  m_tilesY;
+    f32    *m_pDepth;
+    f32    *m_pTileMin;
+    f32    *m_pTileMax;
+
+    // Forbid copy, the buffer owns its memory
+    DepthBuffer(const DepthBuffer& other)               = delete;
+    DepthBuffer& operator=(const DepthBuffer& other)    = delete;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Counters of the depth tested triangles
+////////////////////////////////////////////////////////////////////////////////////////////
+struct DepthStats
+{
+    uint64 fragmentsTested = 0;     // Covered pixels which went through the per pixel depth test
+    uint64 fragmentsRejected = 0;   // Covered pixels which failed it, before any shading
+    uint64 fragmentsPassed = 0;     // Covered pixels which were shaded and written
+    uint64 tilesRejected = 0;       // Hi-z tiles skipped because the triangle is behind them
+    uint64 pixelsRejected = 0;      // Pixels of the bounding box in those tiles, never visited
+    uint64 tilesAccepted = 0;       // Hi-z tiles in front of everything, written without testing
+
+    DepthStats& operator+=(const DepthStats& other)
+    {
+        fragmentsTested += other.fragmentsTested;
+        fragmentsRejected += other.fragmentsRejected;
+        fragmentsPassed += other.fragmentsPassed;
+        tilesRejected += other.tilesRejected;
+        pixelsRejected += other.pixelsRejected;
+        tilesAccepted += other.tilesAccepted;
+        return *this;
+    }
+};
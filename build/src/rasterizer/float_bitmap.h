@@ -0,0 +1,49 @@
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Render target with an arbitrary number of float channels per pixel. The channels of a
+// pixel are stored next to each other, so all layers of a pixel are written together.
+////////////////////////////////////////////////////////////////////////////////////////////
+class FloatBitmap
+{
+public:
+    FloatBitmap(uint32 width, uint32 height, uint32 channels)
+        : m_width(width), m_height(height), m_channels(channels)
+    {
+        m_pPixels = (f32*)calloc((size_t)m_width * m_height * m_channels, sizeof(f32));
+    }
+    ~FloatBitmap() { free(m_pPixels); }
+
+    inline void Clear()
+    {
+        memset(m_pPixels, 0, (size_t)m_width * m_height * m_channels * sizeof(f32));
+    }
+
+    inline f32* GetPixel(uint32 x, uint32 y) const { return m_pPixels + ((size_t)y * m_width + x) * m_channels; }
+
+    inline uint32 GetWidth() const { return m_width; }
+    inline uint32 GetHeight() const { return m_height; }
+    inline uint32 GetChannelCount() const { return m_channels; }
+
+    // Writes one channel as 8 bit gray image, [0, 1] is mapped to [0, 255]
+    void GetChannelGray(uint32 channel, uint8* pDst) const
+    {
+        const f32* pSrc = m_pPixels + channel;
+        size_t count = (size_t)m_width * m_height;
+        for (size_t i = 0; i < count; i++, pSrc += m_channels)
+        {
+            f32 val = *pSrc * 255.0f + 0.5f;
+            pDst[i] = uint8(val <= 0.0f ? 0.0f : (val >= 255.0f ? 255.0f : val));
+        }
+    }
+
+private:
+    uint32  m_width;
+    uint32  m_height;
+    uint32  m_channels;
+    f32    *m_pPixels;
+
+    // Forbid copy, the bitmap owns its pixel memory
+    FloatBitmap(const FloatBitmap& other)               = delete;
+    FloatBitmap& operator=(const FloatBitmap& other)    = delete;
+};
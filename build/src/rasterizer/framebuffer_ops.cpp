@@ -0,0 +1,216 @@
+#include <stdafx.h>
+#include "framebuffer_ops.h"
+#include "bitmap.h"
+
+#ifdef RASTER_X86
+
+#include <emmintrin.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// round(c0 * c1 / 255) of 16 bit lanes holding values up to 255, same as MulDiv255
+static inline __m128i MulDiv255SSE2(__m128i c0, __m128i c1)
+{
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(c0, c1), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Blends two pixels unpacked to 16 bit lanes
+static inline __m128i BlendSSE2(__m128i dst, __m128i src, BlendMode mode)
+{
+    const __m128i max = _mm_set1_epi16(255);
+
+    // Source alpha in all four lanes of a pixel
+    __m128i srcA = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i invA = _mm_sub_epi16(max, srcA);
+
+    switch (mode)
+    {
+    case BlendMode::Alpha:
+    {
+        // The alpha channel itself is not multiplied with alpha
+        const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+        src = MulDiv255SSE2(src, _mm_or_si128(srcA, alphaLanes));
+        return _mm_add_epi16(src, MulDiv255SSE2(dst, invA));
+    }
+    case BlendMode::Premultiplied:
+        return _mm_min_epi16(_mm_add_epi16(src, MulDiv255SSE2(dst, invA)), max);
+    case BlendMode::Multiply:
+        return MulDiv255SSE2(dst, src);
+    default:
+        return src;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+static inline __m128i Blend4SSE2(__m128i dst, __m128i src, BlendMode mode)
+{
+    if (mode == BlendMode::Additive)
+        return _mm_adds_epu8(dst, src);
+
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = BlendSSE2(_mm_unpacklo_epi8(dst, zero), _mm_unpacklo_epi8(src, zero), mode);
+    __m128i hi = BlendSSE2(_mm_unpackhi_epi8(dst, zero), _mm_unpackhi_epi8(src, zero), mode);
+    return _mm_packus_epi16(lo, hi);
+}
+
+#endif
+
+//----------------------------------------------------------------------
+void FillPixels(ColorB* pDst, size_t count, ColorB col)
+{
+#ifdef RASTER_X86
+    // Scalar until the destination is aligned to 16 bytes
+    for (; count > 0 && ((uintptr_t)pDst & 15) != 0; count--)
+        *pDst++ = col;
+
+    uint32 value;
+    memcpy(&value, &col, sizeof(value));
+    const __m128i fill = _mm_set1_epi32((int)value);
+
+    // 16 pixels per iteration, a whole cache line
+    const size_t blocks = count / 16;
+    __m128i* pBlock = (__m128i*)pDst;
+    if (count * sizeof(ColorB) >= FRAMEBUFFER_STREAM_BYTES)
+    {
+        for (size_t i = 0; i < blocks; i++, pBlock += 4)
+        {
+            _mm_stream_si128(pBlock, fill);
+            _mm_stream_si128(pBlock + 1, fill);
+            _mm_stream_si128(pBlock + 2, fill);
+            _mm_stream_si128(pBlock + 3, fill);
+        }
+        // Non temporal stores are weakly ordered, make them visible to other threads
+        _mm_sfence();
+    }
+    else
+    {
+        for (size_t i = 0; i < blocks; i++, pBlock += 4)
+        {
+            _mm_store_si128(pBlock, fill);
+            _mm_store_si128(pBlock + 1, fill);
+            _mm_store_si128(pBlock + 2, fill);
+            _mm_store_si128(pBlock + 3, fill);
+        }
+    }
+
+    pDst += blocks * 16;
+    count -= blocks * 16;
+#endif
+
+    std::fill(pDst, pDst + count, col);
+}
+
+//----------------------------------------------------------------------
+void BlendPixels(ColorB* pDst, const ColorB* pSrc, size_t count, BlendMode mode)
+{
+    if (mode == BlendMode::Replace)
+    {
+        std::copy(pSrc, pSrc + count, pDst);
+        return;
+    }
+
+#ifdef RASTER_X86
+    for (; count >= 4; count -= 4, pDst += 4, pSrc += 4)
+    {
+        __m128i dst = _mm_loadu_si128((const __m128i*)pDst);
+        __m128i src = _mm_loadu_si128((const __m128i*)pSrc);
+        _mm_storeu_si128((__m128i*)pDst, Blend4SSE2(dst, src, mode));
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++)
+        pDst[i] = BlendColor(pDst[i], pSrc[i], mode);
+}
+
+//----------------------------------------------------------------------
+void BlendFill(ColorB* pDst, size_t count, ColorB col, BlendMode mode)
+{
+    if (mode == BlendMode::Replace)
+    {
+        FillPixels(pDst, count, col);
+        return;
+    }
+
+#ifdef RASTER_X86
+    uint32 value;
+    memcpy(&value, &col, sizeof(value));
+    const __m128i src = _mm_set1_epi32((int)value);
+
+    for (; count >= 4; count -= 4, pDst += 4)
+    {
+        __m128i dst = _mm_loadu_si128((const __m128i*)pDst);
+        _mm_storeu_si128((__m128i*)pDst, Blend4SSE2(dst, src, mode));
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++)
+        pDst[i] = BlendColor(pDst[i], col, mode);
+}
+
+//----------------------------------------------------------------------
+void ConvertToRGB(const ColorB* pSrc, size_t count, uint8* pDst)
+{
+    for (size_t i = 0; i < count; i++, pDst += 3)
+    {
+        pDst[0] = pSrc[i].r;
+        pDst[1] = pSrc[i].g;
+        pDst[2] = pSrc[i].b;
+    }
+}
+
+//----------------------------------------------------------------------
+void ConvertToRGBA(const ColorB* pSrc, size_t count, uint8* pDst)
+{
+#ifdef RASTER_X86
+    // Swaps the bytes 0 and 2 of every pixel
+    const __m128i maskGA = _mm_set1_epi32((int)0xff00ff00);
+    const __m128i maskB  = _mm_set1_epi32(0xff);
+
+    for (; count >= 4; count -= 4, pSrc += 4, pDst += 16)
+    {
+        __m128i bgra = _mm_loadu_si128((const __m128i*)pSrc);
+        __m128i rgba = _mm_or_si128(_mm_and_si128(bgra, maskGA),
+                       _mm_or_si128(_mm_and_si128(_mm_srli_epi32(bgra, 16), maskB), _mm_slli_epi32(_mm_and_si128(bgra, maskB), 16)));
+        _mm_storeu_si128((__m128i*)pDst, rgba);
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++, pDst += 4)
+    {
+        pDst[0] = pSrc[i].r;
+        pDst[1] = pSrc[i].g;
+        pDst[2] = pSrc[i].b;
+        pDst[3] = pSrc[i].a;
+    }
+}
+
+//----------------------------------------------------------------------
+void ConvertToGray(const ColorB* pSrc, size_t count, uint8* pDst)
+{
+#ifdef RASTER_X86
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128i weightB = _mm_set1_epi32(29);
+    const __m128i weightG = _mm_set1_epi32(150);
+    const __m128i weightR = _mm_set1_epi32(77);
+    const __m128i round = _mm_set1_epi32(128);
+
+    for (; count >= 4; count -= 4, pSrc += 4, pDst += 4)
+    {
+        // Channels in 32 bit lanes, their products fit into the low 16 bits
+        __m128i bgra = _mm_loadu_si128((const __m128i*)pSrc);
+        __m128i b = _mm_mullo_epi16(_mm_and_si128(bgra, mask), weightB);
+        __m128i g = _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(bgra, 8), mask), weightG);
+        __m128i r = _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi32(bgra, 16), mask), weightR);
+        __m128i gray = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(b, g), _mm_add_epi32(r, round)), 8);
+
+        gray = _mm_packs_epi32(gray, gray);
+        gray = _mm_packus_epi16(gray, gray);
+        uint32 packed = (uint32)_mm_cvtsi128_si32(gray);
+        memcpy(pDst, &packed, sizeof(packed));
+    }
+#endif
+
+    for (size_t i = 0; i < count; i++)
+        pDst[i] = uint8((77 * pSrc[i].r + 150 * pSrc[i].g + 29 * pSrc[i].b + 128) >> 8);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+struct ColorB;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// How a source color is combined with the color already in the bitmap. All modes work on
+// 8 bit integers, products of two channels are divided by 255 and rounded to nearest.
+////////////////////////////////////////////////////////////////////////////////////////////
+enum class BlendMode
+{
+    Replace,        // dst = src
+    Alpha,          // Straight alpha over: dst = src * srcA + dst * (1 - srcA)
+    Premultiplied,  // Premultiplied alpha over: dst = src + dst * (1 - srcA)
+    Additive,       // dst = dst + src, saturating
+    Multiply        // dst = dst * src
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Operations on whole spans of pixels. On x64 they use SSE2, fills larger than
+// FRAMEBUFFER_STREAM_BYTES use non temporal stores, so clearing a big target does not
+// evict everything else from the caches.
+////////////////////////////////////////////////////////////////////////////////////////////
+#define FRAMEBUFFER_STREAM_BYTES (2 << 20)
+
+void FillPixels(ColorB* pDst, size_t count, ColorB col);
+
+void BlendPixels(ColorB* pDst, const ColorB* pSrc, size_t count, BlendMode mode);
+void BlendFill(ColorB* pDst, size_t count, ColorB col, BlendMode mode);
+
+// Conversions of BGRA pixels into caller buffers, which must hold count pixels of the
+// destination format. Gray is the Rec. 601 luma with 8 bit fixed point weights.
+void ConvertToRGB(const ColorB* pSrc, size_t count, uint8* pDst);
+void ConvertToRGBA(const ColorB* pSrc, size_t count, uint8* pDst);
+void ConvertToGray(const ColorB* pSrc, size_t count, uint8* pDst);
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <stdafx.h>
+#include "line_raster.h"
+
+namespace
+{
+    inline f32 Frac(f32 x) { return x - floorf(x); }
+
+    // Blends the color with the coverage as alpha, coordinates outside are skipped. The
+    // alpha of the color is ignored like in the aliased lines, so ColorB(0xRRGGBB) works.
+    inline void PlotCoverage(Bitmap& bitmap, int32 x, int32 y, ColorB col, f32 coverage)
+    {
+        if (x < 0 || y < 0 || x >= (int32)bitmap.GetWidth() || y >= (int32)bitmap.GetHeight())
+            return;
+
+        uint8 alpha = uint8(255.0f * std::min(coverage, 1.0f) + 0.5f);
+        if (alpha != 0)
+            bitmap.BlendPixel(x, y, ColorB{ col.b, col.g, col.r, alpha }, BlendMode::Alpha);
+    }
+}
+
+//----------------------------------------------------------------------
+bool ClipLine(Point2D& p0, Point2D& p1, f32 minX, f32 minY, f32 maxX, f32 maxY)
+{
+    // Most lines are completely inside, NaNs fail these tests and are rejected below
+    if (p0.x >= minX && p0.x <= maxX && p0.y >= minY && p0.y <= maxY &&
+        p1.x >= minX && p1.x <= maxX && p1.y >= minY && p1.y <= maxY)
+        return true;
+
+    if (!std::isfinite(p0.x) || !std::isfinite(p0.y) || !std::isfinite(p1.x) || !std::isfinite(p1.y))
+        return false;
+
+    // Doubles, the difference of two huge floats may not fit into a float
+    const f64 dx = (f64)p1.x - p0.x;
+    const f64 dy = (f64)p1.y - p0.y;
+    const f64 p[4] = { -dx, dx, -dy, dy };
+    const f64 q[4] = { (f64)p0.x - minX, (f64)maxX - p0.x, (f64)p0.y - minY, (f64)maxY - p0.y };
+
+    f64 t0 = 0.0, t1 = 1.0;
+    for (int i = 0; i < 4; i++)
+    {
+        if (p[i] == 0.0)
+        {
+            // Parallel to this border and outside of it
+            if (q[i] < 0.0)
+                return false;
+            continue;
+        }
+
+        f64 t = q[i] / p[i];
+        if (p[i] < 0.0)
+        {
+            if (t > t1)
+                return false;
+            t0 = std::max(t0, t);
+        }
+        else
+        {
+            if (t < t0)
+                return false;
+            t1 = std::min(t1, t);
+        }
+    }
+
+    const Point2D start = p0;
+    if (t0 > 0.0)
+        p0 = { (f32)(start.x + t0 * dx), (f32)(start.y + t0 * dy) };
+    if (t1 < 1.0)
+        p1 = { (f32)(start.x + t1 * dx), (f32)(start.y + t1 * dy) };
+
+    // Rounding may put the new end points a tiny bit outside
+    p0 = { std::min(std::max(p0.x, minX), maxX), std::min(std::max(p0.y, minY), maxY) };
+    p1 = { std::min(std::max(p1.x, minX), maxX), std::min(std::max(p1.y, minY), maxY) };
+    return true;
+}
+
+//----------------------------------------------------------------------
+void RasterizeLineAliased(Bitmap& bitmap, Point2D p0, Point2D p1, ColorB col)
+{
+    const int32 width = (int32)bitmap.GetWidth();
+    const int32 height = (int32)bitmap.GetHeight();
+    if (!ClipLine(p0, p1, 0.0f, 0.0f, (f32)width, (f32)height))
+        return;
+
+    // A point on the right or bottom border belongs to the last pixel
+    int32 x0 = std::min((int32)p0.x, width - 1), y0 = std::min((int32)p0.y, height - 1);
+    int32 x1 = std::min((int32)p1.x, width - 1), y1 = std::min((int32)p1.y, height - 1);
+
+    // Always walk top down, so a line covers the same pixels in both directions
+    if (y0 > y1 || (y0 == y1 && x0 > x1))
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    // Bresenham for all octants, err is the distance to the line scaled by 2 * dx * dy
+    const int32 dx = abs(x1 - x0), stepX = x0 < x1 ? 1 : -1;
+    const int32 dy = -abs(y1 - y0), stepY = y0 < y1 ? 1 : -1;
+    int32 err = dx + dy;
+
+    while (true)
+    {
+        bitmap.GetRow(y0)[x0] = col;
+        if (x0 == x1 && y0 == y1)
+            break;
+
+        int32 err2 = 2 * err;
+        if (err2 >= dy)
+        {
+            err += dy;
+            x0 += stepX;
+        }
+        if (err2 <= dx)
+        {
+            err += dx;
+            y0 += stepY;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+void RasterizeLineAntiAliased(Bitmap& bitmap, Point2D p0, Point2D p1, ColorB col)
+{
+    // Pixels up to one away from the line get coverage
+    if (!ClipLine(p0, p1, -1.0f, -1.0f, bitmap.GetWidth() + 1.0f, bitmap.GetHeight() + 1.0f))
+        return;
+
+    // Wu's algorithm puts pixel centers on integer coordinates
+    f32 x0 = p0.x - 0.5f, y0 = p0.y - 0.5f;
+    f32 x1 = p1.x - 0.5f, y1 = p1.y - 0.5f;
+
+    const bool steep = fabsf(y1 - y0) > fabsf(x1 - x0);
+    if (steep)
+    {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    auto plot = [&](int32 x, int32 y, f32 coverage)
+    {
+        if (steep)
+            PlotCoverage(bitmap, y, x, col, coverage);
+        else
+            PlotCoverage(bitmap, x, y, col, coverage);
+    };
+
+    const f32 dx = x1 - x0;
+    const f32 gradient = dx == 0.0f ? 1.0f : (y1 - y0) / dx;
+
+    // First end point, weighted by how much of its pixel the line covers along x
+    f32 xEnd = floorf(x0 + 0.5f);
+    f32 yEnd = y0 + gradient * (xEnd - x0);
+    f32 xGap = 1.0f - Frac(x0 + 0.5f);
+    const int32 xFirst = (int32)xEnd;
+    plot(xFirst, (int32)floorf(yEnd), (1.0f - Frac(yEnd)) * xGap);
+    plot(xFirst, (int32)floorf(yEnd) + 1, Frac(yEnd) * xGap);
+    f32 yInter = yEnd + gradient;
+
+    // Second end point
+    xEnd = floorf(x1 + 0.5f);
+    yEnd = y1 + gradient * (xEnd - x1);
+    xGap = Frac(x1 + 0.5f);
+    const int32 xLast = (int32)xEnd;
+    plot(xLast, (int32)floorf(yEnd), (1.0f - Frac(yEnd)) * xGap);
+    plot(xLast, (int32)floorf(yEnd) + 1, Frac(yEnd) * xGap);
+
+    for (int32 x = xFirst + 1; x < xLast; x++, yInter += gradient)
+    {
+        int32 y = (int32)floorf(yInter);
+        plot(x, y, 1.0f - Frac(yInter));
+        plot(x, y + 1, Frac(yInter));
+    }
+}
+
+//----------------------------------------------------------------------
+void RasterizeLineWide(Bitmap& bitmap, Point2D p0, Point2D p1, ColorB col, f32 width, bool bAntiAliased)
+{
+    const f32 pad = width + 1.0f;
+    if (!ClipLine(p0, p1, -pad, -pad, bitmap.GetWidth() + pad, bitmap.GetHeight() + pad))
+        return;
+
+    // Walk the major axis as x
+    const bool steep = fabsf(p1.y - p0.y) > fabsf(p1.x - p0.x);
+    if (steep)
+    {
+        std::swap(p0.x, p0.y);
+        std::swap(p1.x, p1.y);
+    }
+    if (p0.x > p1.x)
+        std::swap(p0, p1);
+
+    const int32 majorSize = (int32)(steep ? bitmap.GetHeight() : bitmap.GetWidth());
+    const int32 minorSize = (int32)(steep ? bitmap.GetWidth() : bitmap.GetHeight());
+
+    // Half of the span along the minor axis which gives the width perpendicular to the line
+    const f32 slope = p1.x > p0.x ? (p1.y - p0.y) / (p1.x - p0.x) : 0.0f;
+    const f32 halfSpan = 0.5f * width * sqrtf(1.0f + slope * slope);
+
+    const int32 xStart = std::max((int32)floorf(p0.x), 0);
+    const int32 xEnd = std::min((int32)floorf(p1.x), majorSize - 1);
+    for (int32 x = xStart; x <= xEnd; x++)
+    {
+        f32 centerX = std::min(std::max(x + 0.5f, p0.x), p1.x);
+        f32 centerY = p0.y + slope * (centerX - p0.x);
+        f32 top = centerY - halfSpan;
+        f32 bottom = centerY + halfSpan;
+
+        if (bAntiAliased)
+        {
+            // Coverage is the part of the pixel within the span
+            int32 yStart = std::max((int32)floorf(top), 0);
+            int32 yEnd = std::min((int32)floorf(bottom), minorSize - 1);
+            for (int32 y = yStart; y <= yEnd; y++)
+            {
+                f32 coverage = std::min(bottom, y + 1.0f) - std::max(top, (f32)y);
+                if (steep)
+                    PlotCoverage(bitmap, y, x, col, coverage);
+                else
+                    PlotCoverage(bitmap, x, y, col, coverage);
+            }
+        }
+        else
+        {
+            // Pixels whose center lies within the span
+            int32 yStart = std::max((int32)ceilf(top - 0.5f), 0);
+            int32 yEnd = std::min((int32)ceilf(bottom - 0.5f) - 1, minorSize - 1);
+            for (int32 y = yStart; y <= yEnd; y++)
+            {
+                if (steep)
+                    bitmap.GetRow(x)[y] = col;
+                else
+                    bitmap.GetRow(y)[x] = col;
+            }
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+void RasterizeLine(Bitmap& bitmap, Point2D p0, Point2D p1, ColorB col, const LineStyle& style)
+{
+    if (style.width > 1.0f)
+        RasterizeLineWide(bitmap, p0, p1, col, style.width, style.bAntiAliased);
+    else if (style.bAntiAliased)
+        RasterizeLineAntiAliased(bitmap, p0, p1, col);
+    else
+        RasterizeLineAliased(bitmap, p0, p1, col);
+}
\ No newline at end of file
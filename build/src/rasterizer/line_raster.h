@@ -0,0 +1,31 @@
+#pragma once
+
+#include "bitmap.h"
+#include "triangle_setup.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Positions map to the pixel containing them, so the pixel (x, y) spans [x, x + 1) and its
+// center is at x + 0.5. Lines include both end pixels and are clipped to the bitmap.
+////////////////////////////////////////////////////////////////////////////////////////////
+struct LineStyle
+{
+    f32     width = 1.0f;           // In pixels, measured perpendicular to the line
+    bool    bAntiAliased = false;   // Blends the color with the coverage of every pixel as alpha
+};
+
+// Clips the segment to the rectangle with Liang-Barsky. Returns false if nothing is left
+// or a coordinate is not finite.
+bool ClipLine(Point2D& p0, Point2D& p1, f32 minX, f32 minY, f32 maxX, f32 maxY);
+
+// One pixel wide line with integer Bresenham steps, writes the color as is
+void RasterizeLineAliased(Bitmap& bitmap, Point2D p0, Point2D p1, ColorB col);
+
+// One pixel wide line with Xiaolin Wu's algorithm
+void RasterizeLineAntiAliased(Bitmap& bitmap, Point2D p0, Point2D p1, ColorB col);
+
+// Fills a span across the line for every column (or row, if the line is steep). The ends
+// are cut along the minor axis instead of perpendicular to the line.
+void RasterizeLineWide(Bitmap& bitmap, Point2D p0, Point2D p1, ColorB col, f32 width, bool bAntiAliased);
+
+// Picks the algorithm for the style
+void RasterizeLine(Bitmap& bitmap, Point2D p0, Point2D p1, ColorB col, const LineStyle& style);
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include <stdafx.h>
+#include "raster_kernels.h"
+
+#if defined(RASTER_X86) && defined(_MSC_VER)
+  #include <intrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Pixels are visited row by row, the edge equations are stepped incrementally and the
+// colors are evaluated from their planes at every pixel center, so the result does not
+// depend on the rectangle.
+////////////////////////////////////////////////////////////////////////////////////////////
+void RasterizeTriangleScalar(Bitmap& bitmap, const TriangleSetup& setup, int32 minX, int32 minY, int32 maxX, int32 maxY)
+{
+    const int64 startX = ((int64)minX << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+    const int64 startY = ((int64)minY << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+
+    int64 w0Row = setup.edges[0].Evaluate(startX, startY);
+    int64 w1Row = setup.edges[1].Evaluate(startX, startY);
+    int64 w2Row = setup.edges[2].Evaluate(startX, startY);
+
+    const int64 stepX0 = setup.edges[0].A * SUBPIXEL_ONE, stepY0 = setup.edges[0].B * SUBPIXEL_ONE;
+    const int64 stepX1 = setup.edges[1].A * SUBPIXEL_ONE, stepY1 = setup.edges[1].B * SUBPIXEL_ONE;
+    const int64 stepX2 = setup.edges[2].A * SUBPIXEL_ONE, stepY2 = setup.edges[2].B * SUBPIXEL_ONE;
+
+    for (int32 y = minY; y <= maxY; y++)
+    {
+        int64 w0 = w0Row;
+        int64 w1 = w1Row;
+        int64 w2 = w2Row;
+
+        f32 rowCol[4];
+        for (int i = 0; i < 4; i++)
+            rowCol[i] = setup.col[i] + setup.dColDy[i] * (f32)(y - setup.minY);
+
+        ColorB* pRow = bitmap.GetRow(y);
+        for (int32 x = minX; x <= maxX; x++)
+        {
+            if ((w0 | w1 | w2) >= 0)
+            {
+                f32 dx = (f32)(x - setup.minX);
+                pRow[x] = ColorB{ ToUnorm8(rowCol[0] + setup.dColDx[0] * dx),
+                                  ToUnorm8(rowCol[1] + setup.dColDx[1] * dx),
+                                  ToUnorm8(rowCol[2] + setup.dColDx[2] * dx),
+                                  ToUnorm8(rowCol[3] + setup.dColDx[3] * dx) };
+            }
+
+            w0 += stepX0;
+            w1 += stepX1;
+            w2 += stepX2;
+        }
+
+        w0Row += stepY0;
+        w1Row += stepY1;
+        w2Row += stepY2;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+void RasterizeTriangleChannels(FloatBitmap& target, const TriangleSetup& setup, const f32* const pAttributes[3], uint32 channelMask,
+                               int32 minX, int32 minY, int32 maxX, int32 maxY)
+{
+    // Gather the written channels once, an attribute is a0 + w1 * (a1 - a0) + w2 * (a2 - a0)
+    uint32 channels[32];
+    f32 base[32], delta1[32], delta2[32];
+    uint32 numChannels = 0;
+    for (uint32 c = 0; c < 32 && c < target.GetChannelCount(); c++)
+    {
+        if (!(channelMask & (1u << c)))
+            continue;
+        channels[numChannels] = c;
+        base[numChannels] = pAttributes[0][c];
+        delta1[numChannels] = pAttributes[1][c] - pAttributes[0][c];
+        delta2[numChannels] = pAttributes[2][c] - pAttributes[0][c];
+        numChannels++;
+    }
+    if (numChannels == 0)
+        return;
+
+    const int64 startX = ((int64)minX << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+    const int64 startY = ((int64)minY << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+
+    int64 w0Row = setup.edges[0].Evaluate(startX, startY);
+    int64 w1Row = setup.edges[1].Evaluate(startX, startY);
+    int64 w2Row = setup.edges[2].Evaluate(startX, startY);
+
+    const int64 stepX0 = setup.edges[0].A * SUBPIXEL_ONE, stepY0 = setup.edges[0].B * SUBPIXEL_ONE;
+    const int64 stepX1 = setup.edges[1].A * SUBPIXEL_ONE, stepY1 = setup.edges[1].B * SUBPIXEL_ONE;
+    const int64 stepX2 = setup.edges[2].A * SUBPIXEL_ONE, stepY2 = setup.edges[2].B * SUBPIXEL_ONE;
+
+    for (int32 y = minY; y <= maxY; y++)
+    {
+        int64 w0 = w0Row;
+        int64 w1 = w1Row;
+        int64 w2 = w2Row;
+
+        f32 dy = (f32)(y - setup.minY);
+        f32 rowBary1 = setup.bary[0] + setup.dBaryDy[0] * dy;
+        f32 rowBary2 = setup.bary[1] + setup.dBaryDy[1] * dy;
+
+        for (int32 x = minX; x <= maxX; x++)
+        {
+            if ((w0 | w1 | w2) >= 0)
+            {
+                f32 dx = (f32)(x - setup.minX);
+                f32 bary1 = rowBary1 + setup.dBaryDx[0] * dx;
+                f32 bary2 = rowBary2 + setup.dBaryDx[1] * dx;
+
+                f32* pDst = target.GetPixel(x, y);
+                for (uint32 i = 0; i < numChannels; i++)
+                    pDst[channels[i]] = base[i] + bary1 * delta1[i] + bary2 * delta2[i];
+            }
+
+            w0 += stepX0;
+            w1 += stepX1;
+            w2 += stepX2;
+        }
+
+        w0Row += stepY0;
+        w1Row += stepY1;
+        w2Row += stepY2;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+void RasterizeTriangleDepth(Bitmap& bitmap, DepthBuffer* pDepthBuffer, const TriangleSetup& setup,
+                            int32 minX, int32 minY, int32 maxX, int32 maxY, DepthStats& stats)
+{
+    const int32 tileSize = HIZ_TILE_SIZE;
+
+    int64 stepX[3], stepY[3];
+    for (int i = 0; i < 3; i++)
+    {
+        stepX[i] = setup.edges[i].A * SUBPIXEL_ONE;
+        stepY[i] = setup.edges[i].B * SUBPIXEL_ONE;
+    }
+
+    for (int32 tileY = minY & ~(tileSize - 1); tileY <= maxY; tileY += tileSize)
+    {
+        const int32 y0 = std::max(tileY, minY);
+        const int32 y1 = std::min(tileY + tileSize - 1, maxY);
+
+        for (int32 tileX = minX & ~(tileSize - 1); tileX <= maxX; tileX += tileSize)
+        {
+            const int32 x0 = std::max(tileX, minX);
+            const int32 x1 = std::min(tileX + tileSize - 1, maxX);
+            if (!setup.Overlaps(x0, y0, x1, y1))
+                continue;
+
+            bool bDepthTest = pDepthBuffer != nullptr;
+            if (pDepthBuffer)
+            {
+                // Depth is linear in screen space, its range within the rect is found at the corners
+                f32 cornerX0 = (f32)(x0 - setup.minX) * setup.dZdx, cornerX1 = (f32)(x1 - setup.minX) * setup.dZdx;
+                f32 cornerY0 = (f32)(y0 - setup.minY) * setup.dZdy, cornerY1 = (f32)(y1 - setup.minY) * setup.dZdy;
+                f32 zMin = std::max(setup.z + std::min(cornerX0, cornerX1) + std::min(cornerY0, cornerY1), setup.minZ);
+                f32 zMax = std::min(setup.z + std::max(cornerX0, cornerX1) + std::max(cornerY0, cornerY1), setup.maxZ);
+
+                uint32 hizX = tileX / tileSize, hizY = tileY / tileSize;
+                if (zMin >= pDepthBuffer->GetTileMax(hizX, hizY))
+                {
+                    stats.tilesRejected++;
+                    stats.pixelsRejected += (uint64)(x1 - x0 + 1) * (y1 - y0 + 1);
+                    continue;
+                }
+                if (zMax < pDepthBuffer->GetTileMin(hizX, hizY))
+                {
+                    stats.tilesAccepted++;
+                    bDepthTest = false;
+                }
+            }
+
+            const int64 startX = ((int64)x0 << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+            const int64 startY = ((int64)y0 << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+            int64 wRow[3];
+            for (int i = 0; i < 3; i++)
+                wRow[i] = setup.edges[i].Evaluate(startX, startY);
+
+            bool bDepthWritten = false;
+            for (int32 y = y0; y <= y1; y++)
+            {
+                int64 w0 = wRow[0], w1 = wRow[1], w2 = wRow[2];
+
+                const f32 dy = (f32)(y - setup.minY);
+                ColorB* pRow = bitmap.GetRow(y);
+                f32* pDepthRow = pDepthBuffer ? pDepthBuffer->GetRow(y) : nullptr;
+
+                for (int32 x = x0; x <= x1; x++, w0 += stepX[0], w1 += stepX[1], w2 += stepX[2])
+                {
+                    if ((w0 | w1 | w2) < 0)
+                        continue;
+
+                    const f32 dx = (f32)(x - setup.minX);
+                    if (pDepthRow)
+                    {
+                        f32 z = setup.z + setup.dZdx * dx + setup.dZdy * dy;
+                        if (bDepthTest)
+                        {
+                            stats.fragmentsTested++;
+                            if (!(z < pDepthRow[x]))
+                            {
+                                stats.fragmentsRejected++;
+                                continue;
+                            }
+                        }
+                        pDepthRow[x] = z;
+                        bDepthWritten = true;
+                    }
+
+                    // Color / w and 1 / w are linear in screen space, the color itself is not
+                    f32 w = 1.0f / (setup.invW + setup.dInvWdx * dx + setup.dInvWdy * dy);
+                    pRow[x] = ColorB{ ToUnorm8((setup.colW[0] + setup.dColWdx[0] * dx + setup.dColWdy[0] * dy) * w),
+                                      ToUnorm8((setup.colW[1] + setup.dColWdx[1] * dx + setup.dColWdy[1] * dy) * w),
+                                      ToUnorm8((setup.colW[2] + setup.dColWdx[2] * dx + setup.dColWdy[2] * dy) * w),
+                                      ToUnorm8((setup.colW[3] + setup.dColWdx[3] * dx + setup.dColWdy[3] * dy) * w) };
+                    stats.fragmentsPassed++;
+                }
+
+                for (int i = 0; i < 3; i++)
+                    wRow[i] += stepY[i];
+            }
+
+            if (bDepthWritten)
+                pDepthBuffer->UpdateTile(tileX / tileSize, tileY / tileSize);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+RasterKernel DetectRasterKernel()
+{
+#if defined(RASTER_X86) && defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    int maxLeaf = regs[0];
+
+    __cpuid(regs, 1);
+    bool bOSXSave = (regs[2] & (1 << 27)) != 0;
+    bool bAVX = (regs[2] & (1 << 28)) != 0;
+
+    // The OS must also save the ymm registers on context switches
+    bool bAVX2 = false;
+    if (maxLeaf >= 7 && bOSXSave && bAVX && (_xgetbv(0) & 0x6) == 0x6)
+    {
+        __cpuidex(regs, 7, 0);
+        bAVX2 = (regs[1] & (1 << 5)) != 0;
+    }
+    return bAVX2 ? RasterKernel::AVX2 : RasterKernel::SSE2;
+#elif defined(RASTER_X86)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? RasterKernel::AVX2 : RasterKernel::SSE2;
+#else
+    return RasterKernel::Scalar;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+RasterKernel ResolveRasterKernel(RasterKernel kernel)
+{
+    if (kernel == RasterKernel::Auto)
+        return DetectRasterKernel();
+
+#ifdef RASTER_X86
+    // Never hand out a kernel the cpu can not execute
+    if (kernel == RasterKernel::AVX2 && DetectRasterKernel() != RasterKernel::AVX2)
+        return RasterKernel::SSE2;
+    return kernel;
+#else
+    return RasterKernel::Scalar;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+RasterizeTriangleFunc GetRasterizeTriangleFunc(RasterKernel kernel)
+{
+#ifdef RASTER_X86
+    switch (ResolveRasterKernel(kernel))
+    {
+    case RasterKernel::SSE2: return RasterizeTriangleSSE2;
+    case RasterKernel::AVX2: return RasterizeTriangleAVX2;
+    default: break;
+    }
+#else
+    (void)kernel;
+#endif
+
+    return RasterizeTriangleScalar;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+const char* GetRasterKernelName(RasterKernel kernel)
+{
+    switch (kernel)
+    {
+    case RasterKernel::Auto:   return "auto";
+    case RasterKernel::Scalar: return "scalar";
+    case RasterKernel::SSE2:   return "sse2";
+    case RasterKernel::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "bitmap.h"
+#include "triangle_setup.h"
+#include "float_bitmap.h"
+#include "depth_buffer.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Kernels which fill the pixels of a set up triangle within a rectangle of the bitmap.
+// The scalar kernel is the reference, the SIMD kernels test the coverage of a whole block
+// of pixels at once and produce the same pixels as the scalar one.
+////////////////////////////////////////////////////////////////////////////////////////////
+
+enum class RasterKernel
+{
+    Auto,
+    Scalar,
+    SSE2,   // 4x4 pixel blocks
+    AVX2    // 8x8 pixel blocks
+};
+
+using RasterizeTriangleFunc = void(*)(Bitmap& bitmap, const TriangleSetup& setup, int32 minX, int32 minY, int32 maxX, int32 maxY);
+
+void RasterizeTriangleScalar(Bitmap& bitmap, const TriangleSetup& setup, int32 minX, int32 minY, int32 maxX, int32 maxY);
+#ifdef RASTER_X86
+void RasterizeTriangleSSE2(Bitmap& bitmap, const TriangleSetup& setup, int32 minX, int32 minY, int32 maxX, int32 maxY);
+void RasterizeTriangleAVX2(Bitmap& bitmap, const TriangleSetup& setup, int32 minX, int32 minY, int32 maxX, int32 maxY);
+#endif
+
+// Interpolates up to 32 float attributes per vertex into the channels of the target. Only
+// channels whose bit is set in channelMask are written. pAttributes[i] belongs to vertex pi.
+void RasterizeTriangleChannels(FloatBitmap& target, const TriangleSetup& setup, const f32* const pAttributes[3], uint32 channelMask,
+                               int32 minX, int32 minY, int32 maxX, int32 maxY);
+
+// Fills a triangle set up from a Triangle3D with perspective correct colors. Works on hi-z
+// tiles: tiles the triangle is behind of are skipped, tiles it is in front of are written
+// without per pixel depth test. Without depth buffer no depth test is done at all.
+void RasterizeTriangleDepth(Bitmap& bitmap, DepthBuffer* pDepthBuffer, const TriangleSetup& setup,
+                            int32 minX, int32 minY, int32 maxX, int32 maxY, DepthStats& stats);
+
+// Returns the widest kernel supported by the cpu this is running on
+RasterKernel DetectRasterKernel();
+
+// Returns the kernel which actually runs for the requested one: Auto is detected, AVX2
+// falls back to SSE2 and SIMD kernels fall back to the scalar one off x86
+RasterKernel ResolveRasterKernel(RasterKernel kernel);
+
+// Returns the function of the kernel ResolveRasterKernel() picks
+RasterizeTriangleFunc GetRasterizeTriangleFunc(RasterKernel kernel);
+
+const char* GetRasterKernelName(RasterKernel kernel);
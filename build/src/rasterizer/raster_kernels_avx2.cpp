@@ -0,0 +1,139 @@
+#include <stdafx.h>
+#include "raster_kernels.h"
+
+#ifdef RASTER_X86
+
+#include <immintrin.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Converts the channels of 8 pixels to packed BGRA, rounds and clamps like ToUnorm8
+RASTER_TARGET_AVX2 static inline __m256i PackColorsAVX2(__m256 b, __m256 g, __m256 r, __m256 a)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 max  = _mm256_set1_ps(255.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    __m256i ib = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_min_ps(_mm256_max_ps(b, zero), max), half));
+    __m256i ig = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_min_ps(_mm256_max_ps(g, zero), max), half));
+    __m256i ir = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_min_ps(_mm256_max_ps(r, zero), max), half));
+    __m256i ia = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_min_ps(_mm256_max_ps(a, zero), max), half));
+
+    return _mm256_or_si256(_mm256_or_si256(ib, _mm256_slli_epi32(ig, 8)), _mm256_or_si256(_mm256_slli_epi32(ir, 16), _mm256_slli_epi32(ia, 24)));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Same as the SSE2 kernel but with 8x8 blocks and 8 pixels of a row per iteration.
+////////////////////////////////////////////////////////////////////////////////////////////
+RASTER_TARGET_AVX2 void RasterizeTriangleAVX2(Bitmap& bitmap, const TriangleSetup& setup, int32 minX, int32 minY, int32 maxX, int32 maxY)
+{
+    const int32 blockSize = 8;
+    const int32 width = (int32)bitmap.GetWidth();
+
+    int64   stepY[3];
+    int64   minOffset[3];
+    int64   maxOffset[3];
+    __m256i laneOffsetLo[3];
+    __m256i laneOffsetHi[3];
+    for (int i = 0; i < 3; i++)
+    {
+        int64 stepX = setup.edges[i].A * SUBPIXEL_ONE;
+        stepY[i] = setup.edges[i].B * SUBPIXEL_ONE;
+
+        // Offset from the first pixel of a block to the pixels with the smallest and biggest edge value
+        minOffset[i] = (std::min(stepX, (int64)0) + std::min(stepY[i], (int64)0)) * (blockSize - 1);
+        maxOffset[i] = (std::max(stepX, (int64)0) + std::max(stepY[i], (int64)0)) * (blockSize - 1);
+
+        laneOffsetLo[i] = _mm256_set_epi64x(3 * stepX, 2 * stepX, stepX, 0);
+        laneOffsetHi[i] = _mm256_set_epi64x(7 * stepX, 6 * stepX, 5 * stepX, 4 * stepX);
+    }
+
+    const __m256  laneX    = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    const __m256i laneBits = _mm256_set_epi32(128, 64, 32, 16, 8, 4, 2, 1);
+
+    for (int32 blockY = minY & ~(blockSize - 1); blockY <= maxY; blockY += blockSize)
+    {
+        const int64 py = ((int64)blockY << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+        const int32 rowBegin = std::max(blockY, minY);
+        const int32 rowEnd = std::min(blockY + blockSize - 1, maxY);
+
+        for (int32 blockX = minX & ~(blockSize - 1); blockX <= maxX; blockX += blockSize)
+        {
+            const int64 px = ((int64)blockX << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+
+            int64 w[3];
+            bool bOutside = false;
+            bool bInside = true;
+            for (int i = 0; i < 3; i++)
+            {
+                w[i] = setup.edges[i].Evaluate(px, py);
+                bOutside |= w[i] + maxOffset[i] < 0;
+                bInside &= w[i] + minOffset[i] >= 0;
+            }
+            if (bOutside)
+                continue;
+
+            int rectMask = 0xff;
+            if (blockX < minX)
+                rectMask &= 0xff << (minX - blockX);
+            if (blockX + blockSize - 1 > maxX)
+                rectMask &= 0xff >> (blockX + blockSize - 1 - maxX);
+
+            const __m256 dx = _mm256_add_ps(_mm256_set1_ps((f32)(blockX - setup.minX)), laneX);
+            const __m256 colB = _mm256_mul_ps(_mm256_set1_ps(setup.dColDx[0]), dx);
+            const __m256 colG = _mm256_mul_ps(_mm256_set1_ps(setup.dColDx[1]), dx);
+            const __m256 colR = _mm256_mul_ps(_mm256_set1_ps(setup.dColDx[2]), dx);
+            const __m256 colA = _mm256_mul_ps(_mm256_set1_ps(setup.dColDx[3]), dx);
+
+            for (int32 y = rowBegin; y <= rowEnd; y++)
+            {
+                int mask = rectMask;
+                if (!bInside)
+                {
+                    __m256i orLo = _mm256_setzero_si256();
+                    __m256i orHi = _mm256_setzero_si256();
+                    for (int i = 0; i < 3; i++)
+                    {
+                        __m256i wRow = _mm256_set1_epi64x(w[i] + stepY[i] * (y - blockY));
+                        orLo = _mm256_or_si256(orLo, _mm256_add_epi64(wRow, laneOffsetLo[i]));
+                        orHi = _mm256_or_si256(orHi, _mm256_add_epi64(wRow, laneOffsetHi[i]));
+                    }
+
+                    // A lane is outside if the sign bit of any of its edge values is set
+                    int outside = _mm256_movemask_pd(_mm256_castsi256_pd(orLo)) | (_mm256_movemask_pd(_mm256_castsi256_pd(orHi)) << 4);
+                    mask &= ~outside;
+                }
+                if (mask == 0)
+                    continue;
+
+                const f32 dy = (f32)(y - setup.minY);
+                __m256i colors = PackColorsAVX2(_mm256_add_ps(_mm256_set1_ps(setup.col[0] + setup.dColDy[0] * dy), colB),
+                                                _mm256_add_ps(_mm256_set1_ps(setup.col[1] + setup.dColDy[1] * dy), colG),
+                                                _mm256_add_ps(_mm256_set1_ps(setup.col[2] + setup.dColDy[2] * dy), colR),
+                                                _mm256_add_ps(_mm256_set1_ps(setup.col[3] + setup.dColDy[3] * dy), colA));
+
+                ColorB* pDst = bitmap.GetRow(y) + blockX;
+                if (blockX + blockSize > width)
+                {
+                    // Block reaches over the right border of the bitmap
+                    alignas(32) int32 lanes[8];
+                    _mm256_store_si256((__m256i*)lanes, colors);
+                    for (int lane = 0; lane < blockSize; lane++)
+                        if (mask & (1 << lane))
+                            pDst[lane] = ColorB(lanes[lane]);
+                }
+                else if (mask == 0xff)
+                {
+                    _mm256_storeu_si256((__m256i*)pDst, colors);
+                }
+                else
+                {
+                    __m256i laneMask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask), laneBits), laneBits);
+                    __m256i dst = _mm256_loadu_si256((const __m256i*)pDst);
+                    _mm256_storeu_si256((__m256i*)pDst, _mm256_blendv_epi8(dst, colors, laneMask));
+                }
+            }
+        }
+    }
+}
+
+#endif // RASTER_X86
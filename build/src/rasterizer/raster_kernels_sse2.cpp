@@ -0,0 +1,142 @@
+#include <stdafx.h>
+#include "raster_kernels.h"
+
+#ifdef RASTER_X86
+
+#include <emmintrin.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Converts the channels of 4 pixels to packed BGRA, rounds and clamps like ToUnorm8
+static inline __m128i PackColorsSSE2(__m128 b, __m128 g, __m128 r, __m128 a)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 max  = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    __m128i ib = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(b, zero), max), half));
+    __m128i ig = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(g, zero), max), half));
+    __m128i ir = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(r, zero), max), half));
+    __m128i ia = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(a, zero), max), half));
+
+    return _mm_or_si128(_mm_or_si128(ib, _mm_slli_epi32(ig, 8)), _mm_or_si128(_mm_slli_epi32(ir, 16), _mm_slli_epi32(ia, 24)));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Walks the rectangle in 4x4 blocks aligned to the bitmap. Blocks completely outside of
+// an edge are skipped, blocks completely inside of all edges skip the coverage test.
+// Otherwise the edges are evaluated for 4 pixels of a row at once in 64 bit lanes.
+////////////////////////////////////////////////////////////////////////////////////////////
+void RasterizeTriangleSSE2(Bitmap& bitmap, const TriangleSetup& setup, int32 minX, int32 minY, int32 maxX, int32 maxY)
+{
+    const int32 blockSize = 4;
+    const int32 width = (int32)bitmap.GetWidth();
+
+    int64   stepY[3];
+    int64   minOffset[3];
+    int64   maxOffset[3];
+    __m128i laneOffset01[3];
+    __m128i laneOffset23[3];
+    for (int i = 0; i < 3; i++)
+    {
+        int64 stepX = setup.edges[i].A * SUBPIXEL_ONE;
+        stepY[i] = setup.edges[i].B * SUBPIXEL_ONE;
+
+        // Offset from the first pixel of a block to the pixels with the smallest and biggest edge value
+        minOffset[i] = (std::min(stepX, (int64)0) + std::min(stepY[i], (int64)0)) * (blockSize - 1);
+        maxOffset[i] = (std::max(stepX, (int64)0) + std::max(stepY[i], (int64)0)) * (blockSize - 1);
+
+        laneOffset01[i] = _mm_set_epi64x(stepX, 0);
+        laneOffset23[i] = _mm_set_epi64x(3 * stepX, 2 * stepX);
+    }
+
+    const __m128  laneX    = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128i laneBits = _mm_set_epi32(8, 4, 2, 1);
+
+    for (int32 blockY = minY & ~(blockSize - 1); blockY <= maxY; blockY += blockSize)
+    {
+        const int64 py = ((int64)blockY << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+        const int32 rowBegin = std::max(blockY, minY);
+        const int32 rowEnd = std::min(blockY + blockSize - 1, maxY);
+
+        for (int32 blockX = minX & ~(blockSize - 1); blockX <= maxX; blockX += blockSize)
+        {
+            const int64 px = ((int64)blockX << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+
+            int64 w[3];
+            bool bOutside = false;
+            bool bInside = true;
+            for (int i = 0; i < 3; i++)
+            {
+                w[i] = setup.edges[i].Evaluate(px, py);
+                bOutside |= w[i] + maxOffset[i] < 0;
+                bInside &= w[i] + minOffset[i] >= 0;
+            }
+            if (bOutside)
+                continue;
+
+            int rectMask = 0xf;
+            if (blockX < minX)
+                rectMask &= 0xf << (minX - blockX);
+            if (blockX + blockSize - 1 > maxX)
+                rectMask &= 0xf >> (blockX + blockSize - 1 - maxX);
+
+            const __m128 dx = _mm_add_ps(_mm_set1_ps((f32)(blockX - setup.minX)), laneX);
+            const __m128 colB = _mm_mul_ps(_mm_set1_ps(setup.dColDx[0]), dx);
+            const __m128 colG = _mm_mul_ps(_mm_set1_ps(setup.dColDx[1]), dx);
+            const __m128 colR = _mm_mul_ps(_mm_set1_ps(setup.dColDx[2]), dx);
+            const __m128 colA = _mm_mul_ps(_mm_set1_ps(setup.dColDx[3]), dx);
+
+            for (int32 y = rowBegin; y <= rowEnd; y++)
+            {
+                int mask = rectMask;
+                if (!bInside)
+                {
+                    __m128i or01 = _mm_setzero_si128();
+                    __m128i or23 = _mm_setzero_si128();
+                    for (int i = 0; i < 3; i++)
+                    {
+                        __m128i wRow = _mm_set1_epi64x(w[i] + stepY[i] * (y - blockY));
+                        or01 = _mm_or_si128(or01, _mm_add_epi64(wRow, laneOffset01[i]));
+                        or23 = _mm_or_si128(or23, _mm_add_epi64(wRow, laneOffset23[i]));
+                    }
+
+                    // A lane is outside if the sign bit of any of its edge values is set
+                    int outside = _mm_movemask_pd(_mm_castsi128_pd(or01)) | (_mm_movemask_pd(_mm_castsi128_pd(or23)) << 2);
+                    mask &= ~outside;
+                }
+                if (mask == 0)
+                    continue;
+
+                const f32 dy = (f32)(y - setup.minY);
+                __m128i colors = PackColorsSSE2(_mm_add_ps(_mm_set1_ps(setup.col[0] + setup.dColDy[0] * dy), colB),
+                                                _mm_add_ps(_mm_set1_ps(setup.col[1] + setup.dColDy[1] * dy), colG),
+                                                _mm_add_ps(_mm_set1_ps(setup.col[2] + setup.dColDy[2] * dy), colR),
+                                                _mm_add_ps(_mm_set1_ps(setup.col[3] + setup.dColDy[3] * dy), colA));
+
+                ColorB* pDst = bitmap.GetRow(y) + blockX;
+                if (blockX + blockSize > width)
+                {
+                    // Block reaches over the right border of the bitmap
+                    alignas(16) int32 lanes[4];
+                    _mm_store_si128((__m128i*)lanes, colors);
+                    for (int lane = 0; lane < blockSize; lane++)
+                        if (mask & (1 << lane))
+                            pDst[lane] = ColorB(lanes[lane]);
+                }
+                else if (mask == 0xf)
+                {
+                    _mm_storeu_si128((__m128i*)pDst, colors);
+                }
+                else
+                {
+                    __m128i laneMask = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(mask), laneBits), laneBits);
+                    __m128i dst = _mm_loadu_si128((const __m128i*)pDst);
+                    dst = _mm_or_si128(_mm_and_si128(laneMask, colors), _mm_andnot_si128(laneMask, dst));
+                    _mm_storeu_si128((__m128i*)pDst, dst);
+                }
+            }
+        }
+    }
+}
+
+#endif // RASTER_X86
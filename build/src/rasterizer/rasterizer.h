@@ -1,341 +1,501 @@
 #pragma once
 
+#include "bitmap.h"
+#include "raster_kernels.h"
+#include "line_raster.h"
+#include "present/present_target.h"
+#include "jobs/job_system.h"
+#include "profiler/profiler.h"
+
 ////////////////////////////////////////////////////////////////////////////////////////////
-struct ColorB
+struct ScanRange
 {
-    unsigned char b, g, r, a;
-
-public:
-    ColorB(unsigned char b, unsigned char g, unsigned char r, unsigned char a = 0xff)
-        : b(b), g(g), r(r), a(a)
-    {
-    }
-
-    ColorB(int val)
-    {
-        b = (val & 0x000000ff) >> 0;
-        g = (val & 0x0000ff00) >> 8;
-        r = (val & 0x00ff0000) >> 16;
-        a = (val & 0xff000000) >> 24;
-    }
-
-    ColorB operator*(f32 val) const
-    {
-        return ColorB{ unsigned char(b * val), unsigned char(g * val),  unsigned char(r * val), unsigned char(a * val) };
-    }
-
-    ColorB operator+(ColorB c) const
-    {
-        return ColorB{ unsigned char(b + c.b), unsigned char(g + c.g), unsigned char(r + c.r), unsigned char(a + c.a) };
-    }
-
-    ColorB operator+=(ColorB c) const
-    {
-        return *this + c;
-    }
+    uint32 min;
+    uint32 max;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////
-struct Point2D
+// Output of the vertex processing stage. Primitives whose vertices are all culled are skipped.
+////////////////////////////////////////////////////////////////////////////////////////////
+struct Vertex2D
 {
-    f32 x;
-    f32 y;
+    Point2D position;
+    ColorB  color;
+    bool    bCulled;
+
+    // Only used with a depth buffer: depth in [0, 1] and clip space w
+    f32     z = 0.0f;
+    f32     w = 1.0f;
 };
 
-////////////////////////////////////////////////////////////////////////////////////////////
-struct Vec3
+// Transforms and shades the input vertex with the given index
+using VertexShader = std::function<Vertex2D(uint32 vertexIndex)>;
+
+enum class PrimitiveType
 {
-    f32 x, y, z;
+    Triangles,      // Filled triangles
+    TriangleEdges,  // Wireframe of the triangles, edges shared by triangles are drawn once
+    Points,         // Vertices of the triangles
+    Lines           // Index pairs, every distinct pair is drawn once
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////
-struct ScanRange
+// Primitives submitted since the last ResetStats()
+////////////////////////////////////////////////////////////////////////////////////////////
+struct RasterStats
 {
-    uint32 min;
-    uint32 max;
+    uint64  triangles = 0;          // Triangles that passed setup
+    uint64  trianglesCulled = 0;    // Degenerate, not finite or entirely off screen
+    uint64  lines = 0;
+    uint64  points = 0;
+    f64     triangleArea = 0.0;     // Screen area in pixels of the set up triangles, ignores clipping
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////
-struct Triangle2D
-{
-    Point2D p0;
-    Point2D p1;
-    Point2D p2;
-
-    ColorB c0;
-    ColorB c1;
-    ColorB c2;
-
-    Vec3 ComputeBarycentricCoordinates(const Point2D& p) const
-    {
-        f32 w0 = ((p1.y - p2.y)*(p.x - p2.x) + (p2.x - p1.x)*(p.y - p2.y)) / ((p1.y - p2.y)*(p0.x - p2.x) + (p2.x - p1.x)*(p0.y - p2.y));
-        f32 w1 = ((p2.y - p0.y)*(p.x - p2.x) + (p0.x - p2.x)*(p.y - p2.y)) / ((p1.y - p2.y)*(p0.x - p2.x) + (p2.x - p1.x)*(p0.y - p2.y));
-        f32 w2 = 1 - w1 - w0;
-        return Vec3{ w0, w1, w2 };
-    }
-};
+// Size in pixels of the screen tiles triangles are binned into when running multithreaded.
+// Must be a multiple of the block size of every raster kernel.
+////////////////////////////////////////////////////////////////////////////////////////////
+#define TILE_SIZE 64
 
 ////////////////////////////////////////////////////////////////////////////////////////////
-class Window
+class Rasterizer
 {
 public:
-    Window(uint32 width, uint32 height, bool bCenter, WNDPROC wndProc)
-        : m_width(width), m_height(height)
+    Rasterizer(IPresentTarget& target)
+        : m_target(target), m_bitmap(target.GetWidth(), target.GetHeight())
     {
-        LPCWSTR strClassName = L"Software Rasterizer";
-        LPCWSTR strTitle = L"Software Rasterizer";
-
-        //Step 1: Registering the Window Class
-        WNDCLASSEX wc;
-        wc.cbSize = sizeof(WNDCLASSEX);
-        wc.style = 0;
-        wc.lpfnWndProc = wndProc;
-        wc.cbClsExtra = 0;
-        wc.cbWndExtra = 0;
-        wc.hInstance = m_hInstance;
-        wc.hIcon = LoadIcon(NULL, IDI_APPLICATION);
-        wc.hCursor = LoadCursor(NULL, IDC_ARROW);
-        wc.hbrBackground = NULL;
-        wc.lpszMenuName = NULL;
-        wc.lpszClassName = strClassName;
-        wc.hIconSm = LoadIcon(NULL, IDI_APPLICATION);
-        RegisterClassEx(&wc);
-
-        UINT x = CW_USEDEFAULT;
-        UINT y = CW_USEDEFAULT;
-        if (bCenter)
-        {
-            UINT screenResX = GetSystemMetrics(SM_CXSCREEN);
-            UINT screenResY = GetSystemMetrics(SM_CYSCREEN);
-            x = (UINT)(screenResX * 0.5f - (width * 0.5f));
-            y = (UINT)(screenResY * 0.5f - (height * 0.5f));
-        }
-        DWORD windowStyle = WS_OVERLAPPEDWINDOW;
+        m_scanBuffer = (ScanRange*)calloc(target.GetHeight(), sizeof(ScanRange));
+        SetRasterKernel(RasterKernel::Auto);
 
-        // Calculate real window size (with borders)
-        RECT r{ 0, 0, (LONG)width, (LONG)height };
-        AdjustWindowRect(&r, windowStyle, FALSE);
-        UINT w = r.right - r.left;
-        UINT h = r.bottom - r.top;
-
-        m_hwnd = CreateWindowEx(WS_EX_CLIENTEDGE, strClassName, strTitle, windowStyle, x, y, w, h, NULL, NULL, m_hInstance, NULL);
-
-        ShowWindow(m_hwnd, SW_SHOW);
-        UpdateWindow(m_hwnd);
-
-        m_hdc = GetDC(m_hwnd);
+        m_tilesX = (m_bitmap.GetWidth() + TILE_SIZE - 1) / TILE_SIZE;
+        m_tilesY = (m_bitmap.GetHeight() + TILE_SIZE - 1) / TILE_SIZE;
+        m_tileBins.resize(m_tilesX * m_tilesY);
+    }
+    ~Rasterizer()
+    {
+        free(m_scanBuffer);
     }
 
-    inline uint32 GetWidth() const { return m_width; }
-    inline uint32 GetHeight() const { return m_height; }
+    // Pending triangles are flushed before the bitmap is handed out
+    Bitmap& GetBitmap() { Flush(); return m_bitmap; }
+    IPresentTarget& GetTarget() { return m_target; }
+
+    void Clear() { PROFILE_ZONE("Clear"); DiscardBins(); m_bitmap.Clear(); ClearDepth(); }
+    void ClearDepth(f32 depth = 1.0f) { if (m_depthBuffer) m_depthBuffer->Clear(depth); }
 
-    void SetTitle(const wchar_t* newTitle, ...)
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // Triangle3Ds are depth tested against the depth buffer if there is one
+    ///////////////////////////////////////////////////////////////////////////////////////
+    void EnableDepthBuffer(bool bEnable)
     {
-        WCHAR buffer[256]{};
-        va_list args;
-        va_start(args, newTitle);
-        vswprintf(buffer, 256, newTitle, args);
-        va_end(args);
-        SetWindowText(m_hwnd, buffer);
+        Flush();
+        if (bEnable && !m_depthBuffer)
+            m_depthBuffer = std::make_unique<DepthBuffer>(m_bitmap.GetWidth(), m_bitmap.GetHeight());
+        else if (!bEnable)
+            m_depthBuffer.reset();
     }
+    DepthBuffer* GetDepthBuffer() { Flush(); return m_depthBuffer.get(); }
 
-    void SwapBuffers(const void* pPixels) const
-    {
-        HBITMAP bitmap = CreateBitmap(m_width, m_height, 1, 32, (void*)pPixels);
+    DepthStats GetDepthStats() { Flush(); return m_depthStats; }
+    void ResetDepthStats() { m_depthStats = DepthStats(); }
+    void SwapBuffers() { Flush(); PROFILE_ZONE("Present"); m_target.Present(m_bitmap); }
 
-        HDC src = CreateCompatibleDC(m_hdc);
-        SelectObject(src, bitmap);
+    RasterStats GetStats() const { return m_stats; }
+    void ResetStats() { m_stats = RasterStats(); }
 
-        BitBlt(m_hdc, 0, 0, m_width, m_height, src, 0, 0, SRCCOPY);
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // With more than one thread triangles are only binned into screen tiles and get
+    // rasterized tile by tile in parallel on Flush(). Every tile is owned by a single
+    // thread and keeps the submission order, so the result is identical to one thread.
+    // 0 uses all hardware threads.
+    ///////////////////////////////////////////////////////////////////////////////////////
+    void SetThreadCount(uint32 numThreads)
+    {
+        Flush();
 
-        DeleteDC(src);
-        DeleteObject(bitmap);
+        m_jobSystem = std::make_unique<JobSystem>(numThreads);
+        if (m_jobSystem->GetThreadCount() == 1)
+            m_jobSystem.reset();
     }
+    uint32 GetThreadCount() const { return m_jobSystem ? m_jobSystem->GetThreadCount() : 1; }
 
-    bool HandleMessages() const
+    ///////////////////////////////////////////////////////////////////////////////////////
+    void FillTriangle(const Triangle2D& t)
     {
-        bool bKeepRunning = true;
-
-        MSG msg;
-        while (PeekMessage(&msg, NULL, NULL, NULL, PM_REMOVE))
+        TriangleSetup setup;
         {
-            if (msg.message == WM_QUIT)
-                bKeepRunning = false;
+            PROFILE_PRIMITIVE_ZONE("Setup");
+            if (!SetupTriangle(t, setup))
+            {
+                m_stats.trianglesCulled++;
+                return;
+            }
 
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
+            m_stats.triangles++;
+            m_stats.triangleArea += TriangleArea(t.p0, t.p1, t.p2);
+            if (m_jobSystem)
+            {
+                BinTriangle(setup);
+                return;
+            }
         }
 
-        return bKeepRunning;
+        PROFILE_PRIMITIVE_ZONE("Raster");
+        RasterizeTriangle(setup, setup.minX, setup.minY, setup.maxX, setup.maxY);
     }
 
-private:
-    uint32    m_width;
-    uint32    m_height;
-    HWND      m_hwnd;
-    HINSTANCE m_hInstance;
-    HDC       m_hdc;
-};
-
-class Bitmap
-{
-public:
-    Bitmap(uint32 width, uint32 height)
-        : m_width(width), m_height(height)
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // Vertex processing stage: runs the shader exactly once for every vertex in
+    // [0, vertexCount). Runs on all raster threads, so the shader must be thread safe.
+    ///////////////////////////////////////////////////////////////////////////////////////
+    void ProcessVertices(uint32 vertexCount, const VertexShader& shader, std::vector<Vertex2D>& vertices)
     {
-        m_pPixels = (ColorB*)calloc(m_width * m_height, sizeof(ColorB));
-    }
-    ~Bitmap() { free(m_pPixels); }
+        PROFILE_ZONE("Vertices");
+        vertices.resize(vertexCount);
 
-    inline void Clear()
-    {
-        memset(m_pPixels, 0, m_width * m_height * sizeof(ColorB));
+        const uint32 chunkSize = 1024;
+        const uint32 numChunks = (vertexCount + chunkSize - 1) / chunkSize;
+        auto processChunk = [&](uint32 chunk)
+        {
+            uint32 end = std::min(vertexCount, (chunk + 1) * chunkSize);
+            for (uint32 v = chunk * chunkSize; v < end; v++)
+                vertices[v] = shader(v);
+        };
+
+        if (m_jobSystem && numChunks > 1)
+            m_jobSystem->ParallelFor(numChunks, processChunk);
+        else
+            for (uint32 chunk = 0; chunk < numChunks; chunk++)
+                processChunk(chunk);
     }
 
-    inline void Clear(ColorB col)
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // Draws a triangle list of already processed vertices. Indices may be 16 or 32 bit,
+    // triangles referencing vertices outside of the buffer are skipped. Triangles are
+    // handled like every other one, so with binning many draw calls end up in one flush.
+    ///////////////////////////////////////////////////////////////////////////////////////
+    template<typename TIndex>
+    void DrawIndexed(const Vertex2D* pVertices, uint32 vertexCount, const TIndex* pIndices, uint32 indexCount, PrimitiveType type = PrimitiveType::Triangles)
     {
-        for (uint32 x = 0; x < m_width; x++)
-            for (uint32 y = 0; y < m_height; y++)
-                SetPixel(x, y, col);
+        static_assert(std::is_unsigned<TIndex>::value, "Indices must be unsigned integers");
+        if (type == PrimitiveType::TriangleEdges || type == PrimitiveType::Lines)
+        {
+            DrawLines(pVertices, vertexCount, pIndices, indexCount, type);
+            return;
+        }
+
+        // Timed per draw call. Triangles are set up and binned, or also rasterized without
+        // job system. Points are drawn immediately and flush the binned triangles first.
+        if (type == PrimitiveType::Points)
+            Flush();
+        PROFILE_ZONE(type == PrimitiveType::Points ? "Points" : "Triangles");
+
+        for (uint32 idx = 0; idx + 2 < indexCount; idx += 3)
+        {
+            uint32 i0 = pIndices[idx];
+            uint32 i1 = pIndices[idx + 1];
+            uint32 i2 = pIndices[idx + 2];
+            if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+                continue;
+
+            const Vertex2D& v0 = pVertices[i0];
+            const Vertex2D& v1 = pVertices[i1];
+            const Vertex2D& v2 = pVertices[i2];
+            if (v0.bCulled && v1.bCulled && v2.bCulled)
+                continue;
+
+            switch (type)
+            {
+            case PrimitiveType::Triangles:
+                if (m_depthBuffer)
+                    FillTriangle3D(Triangle3D{ { v0.position.x, v0.position.y, v0.z }, { v1.position.x, v1.position.y, v1.z }, { v2.position.x, v2.position.y, v2.z },
+                                             v0.w, v1.w, v2.w, v0.color, v1.color, v2.color });
+                else
+                    FillTriangle(Triangle2D{ v0.position, v1.position, v2.position, v0.color, v1.color, v2.color });
+                break;
+            case PrimitiveType::Points:
+                DrawPoint(v0.position, v0.color);
+                DrawPoint(v1.position, v1.color);
+                DrawPoint(v2.position, v2.color);
+                break;
+            default:
+                break;
+            }
+        }
     }
 
-    inline void BlendPixel(uint32 x, uint32 y, ColorB col)
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // Draws the edges of a triangle list or an index pair list. Every edge is drawn once,
+    // in the order it first appears, from its first vertex and with that vertex's color.
+    // Primitives whose vertices are all culled are skipped like in DrawIndexed.
+    ///////////////////////////////////////////////////////////////////////////////////////
+    template<typename TIndex>
+    void DrawLines(const Vertex2D* pVertices, uint32 vertexCount, const TIndex* pIndices, uint32 indexCount,
+                   PrimitiveType type = PrimitiveType::Lines, const LineStyle& style = LineStyle())
     {
-        int index = y * m_width + x;
+        static_assert(std::is_unsigned<TIndex>::value, "Indices must be unsigned integers");
+        // Lines are drawn immediately, keep them in order with the binned triangles
+        Flush();
+        PROFILE_ZONE("Lines");
 
-        f32 a = col.a / 255.0f;
-        m_pPixels[index].r = unsigned char(m_pPixels[index].r * (1.0f - a) + col.r * a);
-        m_pPixels[index].g = unsigned char(m_pPixels[index].g * (1.0f - a) + col.g * a);
-        m_pPixels[index].b = unsigned char(m_pPixels[index].b * (1.0f - a) + col.b * a);
+        m_edgeCache.clear();
+        auto addEdge = [this](uint32 from, uint32 to) { m_edgeCache.push_back({ from, to, false }); };
+
+        const uint32 stride = type == PrimitiveType::TriangleEdges ? 3 : 2;
+        for (uint32 idx = 0; idx + stride - 1 < indexCount; idx += stride)
+        {
+            uint32 i0 = pIndices[idx];
+            uint32 i1 = pIndices[idx + 1];
+            uint32 i2 = stride == 3 ? (uint32)pIndices[idx + 2] : i1;
+            if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount)
+                continue;
+            if (pVertices[i0].bCulled && pVertices[i1].bCulled && pVertices[i2].bCulled)
+                continue;
+
+            addEdge(i0, i1);
+            if (stride == 3)
+            {
+                addEdge(i1, i2);
+                addEdge(i2, i0);
+            }
+        }
+
+        MarkDuplicateEdges(vertexCount);
+
+        for (const LineEdge& edge : m_edgeCache)
+        {
+            if (edge.bDuplicate)
+                continue;
+
+            RasterizeLine(m_bitmap, pVertices[edge.from].position, pVertices[edge.to].position, pVertices[edge.from].color, style);
+            m_stats.lines++;
+        }
     }
 
-    inline void SetPixel(uint32 x, uint32 y, ColorB col)
+    // Runs the vertex processing stage and draws the result
+    template<typename TIndex>
+    void DrawIndexed(uint32 vertexCount, const VertexShader& shader, const TIndex* pIndices, uint32 indexCount, PrimitiveType type = PrimitiveType::Triangles)
     {
-        int index = y * m_width + x;
-        m_pPixels[index] = col;
+        ProcessVertices(vertexCount, shader, m_vertexCache);
+        DrawIndexed(m_vertexCache.data(), vertexCount, pIndices, indexCount, type);
     }
 
-    inline uint32 GetWidth() const { return m_width; }
-    inline uint32 GetHeight() const { return m_height; }
-    inline void* GetData() const { return m_pPixels; }
-    std::vector<char> GetDataRGB() const
+    ///////////////////////////////////////////////////////////////////////////////////////
+    void FillTriangle3D(const Triangle3D& t)
     {
-        std::vector<char> pPixels(m_width * m_height * 3, 0);
-        for (uint32 x = 0; x < m_width; x++)
+        TriangleSetup setup;
         {
-            for (uint32 y = 0; y < m_height; y++)
+            PROFILE_PRIMITIVE_ZONE("Setup");
+            if (!::SetupTriangle(t, m_bitmap.GetWidth(), m_bitmap.GetHeight(), setup))
+            {
+                m_stats.trianglesCulled++;
+                return;
+            }
+
+            m_stats.triangles++;
+            m_stats.triangleArea += TriangleArea({ t.p0.x, t.p0.y }, { t.p1.x, t.p1.y }, { t.p2.x, t.p2.y });
+            if (m_jobSystem)
             {
-                ColorB col = m_pPixels[m_width * y + x];
-                int index = m_width * y + x;
-                pPixels[3 * index] = col.b;
-                pPixels[3 * index + 1] = col.g;
-                pPixels[3 * index + 2] = col.r;
+                BinTriangle(setup);
+                return;
             }
         }
-        return pPixels;
+
+        PROFILE_PRIMITIVE_ZONE("Raster");
+        RasterizeTriangle(setup, setup.minX, setup.minY, setup.maxX, setup.maxY);
     }
 
-private:
-    uint32  m_width;
-    uint32  m_height;
-    ColorB *m_pPixels;
-};
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // Rasterizes all pending triangles, one job per tile that has any
+    ///////////////////////////////////////////////////////////////////////////////////////
+    void Flush()
+    {
+        if (m_binnedTriangles.empty())
+            return;
 
+        PROFILE_ZONE("Raster");
+        m_activeTiles.clear();
+        for (uint32 tile = 0; tile < m_tileBins.size(); tile++)
+            if (!m_tileBins[tile].empty())
+                m_activeTiles.push_back(tile);
 
-////////////////////////////////////////////////////////////////////////////////////////////
-class Rasterizer
-{
-public:
-    Rasterizer(Window& window)
-        : m_window(window), m_bitmap(window.GetWidth(), window.GetHeight())
-    {
-        m_scanBuffer = (ScanRange*)calloc(window.GetHeight(), sizeof(ScanRange));
+        m_jobSystem->ParallelFor((uint32)m_activeTiles.size(), [this](uint32 job) { RasterizeTile(m_activeTiles[job]); });
+
+        DiscardBins();
     }
-    ~Rasterizer()
+
+    ///////////////////////////////////////////////////////////////////////////////////////
+    bool SetupTriangle(const Triangle2D& t, TriangleSetup& setup) const
     {
-        free(m_scanBuffer);
+        return ::SetupTriangle(t, m_bitmap.GetWidth(), m_bitmap.GetHeight(), setup);
     }
 
-    Bitmap& GetBitmap() { return m_bitmap; }
-    Window& GetWindow() { return m_window; }
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // Fills all pixels of the given rectangle which are covered by the triangle. The rect
+    // must lie within the bounding box of the setup.
+    ///////////////////////////////////////////////////////////////////////////////////////
+    void RasterizeTriangle(const TriangleSetup& setup, int32 minX, int32 minY, int32 maxX, int32 maxY)
+    {
+        if (setup.bDepth)
+            RasterizeTriangleDepth(m_bitmap, m_depthBuffer.get(), setup, minX, minY, maxX, maxY, m_depthStats);
+        else
+            m_rasterizeFunc(m_bitmap, setup, minX, minY, maxX, maxY);
+    }
 
-    void Clear() { m_bitmap.Clear(); }
-    void SwapBuffers() const { m_window.SwapBuffers(m_bitmap.GetData()); }
+    ///////////////////////////////////////////////////////////////////////////////////////
+    // Selects the kernel used to fill triangles. Auto picks the widest one the cpu supports.
+    ///////////////////////////////////////////////////////////////////////////////////////
+    void SetRasterKernel(RasterKernel kernel)
+    {
+        m_rasterKernel = ResolveRasterKernel(kernel);
+        m_rasterizeFunc = GetRasterizeTriangleFunc(m_rasterKernel);
+    }
+    RasterKernel GetRasterKernel() const { return m_rasterKernel; }
 
     ///////////////////////////////////////////////////////////////////////////////////////
-    void FillTriangle(const Triangle2D& t)
+    void DrawPoint(Point2D p, ColorB col)
     {
-        Point2D min{};
-        Point2D max{};
+        Flush();
+        PROFILE_PRIMITIVE_ZONE("Point");
 
-        min.x = t.p0.x < t.p1.x ? (t.p0.x < t.p2.x ? t.p0.x : t.p2.x) : (t.p1.x < t.p2.x ? t.p1.x : t.p2.x);
-        min.y = t.p0.y < t.p1.y ? (t.p0.y < t.p2.y ? t.p0.y : t.p2.y) : (t.p1.y < t.p2.y ? t.p1.y : t.p2.y);
+        m_stats.points++;
+        if (p.x >= 0.0f && p.y >= 0.0f && p.x < (f32)m_bitmap.GetWidth() && p.y < (f32)m_bitmap.GetHeight())
+            m_bitmap.SetPixel((uint32)p.x, (uint32)p.y, col);
+    }
 
-        max.x = t.p0.x > t.p1.x ? (t.p0.x > t.p2.x ? t.p0.x : t.p2.x) : (t.p1.x > t.p2.x ? t.p1.x : t.p2.x);
-        max.y = t.p0.y > t.p1.y ? (t.p0.y > t.p2.y ? t.p0.y : t.p2.y) : (t.p1.y > t.p2.y ? t.p1.y : t.p2.y);
+    ///////////////////////////////////////////////////////////////////////////////////////
+    void DrawLine(Point2D p0, Point2D p1, ColorB col, const LineStyle& style = LineStyle())
+    {
+        // Lines are drawn immediately, keep them in order with the binned triangles
+        Flush();
+        PROFILE_PRIMITIVE_ZONE("Line");
+        m_stats.lines++;
 
-        for (int x = (int)min.x; x <= (int)max.x; x++)
+        RasterizeLine(m_bitmap, p0, p1, col, style);
+    }
+
+private:
+    IPresentTarget&       m_target;
+    Bitmap                m_bitmap;
+    ScanRange            *m_scanBuffer;
+    RasterKernel          m_rasterKernel;
+    RasterizeTriangleFunc m_rasterizeFunc;
+
+    std::unique_ptr<JobSystem>          m_jobSystem;
+    uint32                              m_tilesX;
+    uint32                              m_tilesY;
+    std::vector<TriangleSetup>          m_binnedTriangles;
+    std::vector<std::vector<uint32>>    m_tileBins;
+    std::vector<uint32>                 m_activeTiles;
+    std::vector<Vertex2D>               m_vertexCache;
+
+    struct LineEdge
+    {
+        uint32  from;
+        uint32  to;
+        bool    bDuplicate;
+    };
+    std::vector<LineEdge>               m_edgeCache;
+    std::vector<uint32>                 m_edgeOffsets;
+    std::vector<uint32>                 m_edgeBuckets;
+
+    // Marks every edge of the cache which connects the same vertices as an earlier one.
+    // Edges are bucketed by their smaller vertex, so duplicates only have to be searched
+    // among the few edges of a vertex.
+    void MarkDuplicateEdges(uint32 vertexCount)
+    {
+        m_edgeOffsets.assign(vertexCount + 1, 0);
+        for (const LineEdge& edge : m_edgeCache)
+            m_edgeOffsets[std::min(edge.from, edge.to) + 1]++;
+        for (uint32 v = 0; v < vertexCount; v++)
+            m_edgeOffsets[v + 1] += m_edgeOffsets[v];
+
+        // Filling the buckets moves every offset to the start of the next bucket
+        m_edgeBuckets.resize(m_edgeCache.size());
+        for (uint32 i = 0; i < (uint32)m_edgeCache.size(); i++)
+            m_edgeBuckets[m_edgeOffsets[std::min(m_edgeCache[i].from, m_edgeCache[i].to)]++] = i;
+
+        uint32 bucketStart = 0;
+        for (uint32 v = 0; v < vertexCount; v++)
         {
-            for (int y = (int)min.y; y <= (int)max.y; y++)
+            const uint32 bucketEnd = m_edgeOffsets[v];
+            for (uint32 i = bucketStart; i < bucketEnd; i++)
             {
-                Point2D p{ (f32)x, (f32)y };
-                Vec3 bary = t.ComputeBarycentricCoordinates(p);
-
-                if (bary.x < -0.00001f || bary.y < -0.00001f || bary.z < -0.00001f)
-                    continue;
-
-                ColorB col = t.c0 * bary.x + t.c1 * bary.y + t.c2 * bary.z;
-                m_bitmap.SetPixel((uint32)p.x, (uint32)p.y, col);
+                LineEdge& edge = m_edgeCache[m_edgeBuckets[i]];
+                const uint32 other = std::max(edge.from, edge.to);
+                for (uint32 j = bucketStart; j < i && !edge.bDuplicate; j++)
+                {
+                    const LineEdge& earlier = m_edgeCache[m_edgeBuckets[j]];
+                    edge.bDuplicate = std::max(earlier.from, earlier.to) == other;
+                }
             }
+            bucketStart = bucketEnd;
         }
     }
 
-    ///////////////////////////////////////////////////////////////////////////////////////
-    void DrawLine(Point2D p0, Point2D p1, ColorB col)
+    std::unique_ptr<DepthBuffer>        m_depthBuffer;
+    DepthStats                          m_depthStats;
+    std::mutex                          m_statsMutex;
+    RasterStats                         m_stats;
+
+    static f64 TriangleArea(Point2D p0, Point2D p1, Point2D p2)
     {
-        // Bresenham's line algorithm
-        const bool steep = (fabs(p1.y - p0.y) > fabs(p1.x - p0.x));
-        if (steep)
-        {
-            std::swap(p0.x, p0.y);
-            std::swap(p1.x, p1.y);
-        }
+        return fabs(((f64)p1.x - p0.x) * ((f64)p2.y - p0.y) - ((f64)p2.x - p0.x) * ((f64)p1.y - p0.y)) * 0.5;
+    }
 
-        if (p0.x > p1.x)
+    void BinTriangle(const TriangleSetup& setup)
+    {
+        uint32 index = (uint32)m_binnedTriangles.size();
+        m_binnedTriangles.push_back(setup);
+
+        for (int32 tileY = setup.minY / TILE_SIZE; tileY <= setup.maxY / TILE_SIZE; tileY++)
         {
-            std::swap(p0.x, p1.x);
-            std::swap(p0.y, p1.y);
+            for (int32 tileX = setup.minX / TILE_SIZE; tileX <= setup.maxX / TILE_SIZE; tileX++)
+            {
+                int32 minX = std::max(tileX * TILE_SIZE, setup.minX);
+                int32 minY = std::max(tileY * TILE_SIZE, setup.minY);
+                int32 maxX = std::min(tileX * TILE_SIZE + TILE_SIZE - 1, setup.maxX);
+                int32 maxY = std::min(tileY * TILE_SIZE + TILE_SIZE - 1, setup.maxY);
+                if (setup.Overlaps(minX, minY, maxX, maxY))
+                    m_tileBins[tileY * m_tilesX + tileX].push_back(index);
+            }
         }
+    }
 
-        const float dx = p1.x - p0.x;
-        const float dy = fabs(p1.y - p0.y);
-
-        float error = dx / 2.0f;
-        const int ystep = (p0.y < p1.y) ? 1 : -1;
-        int y = (int)p0.y;
-
-        const int maxX = (int)p1.x;
+    void RasterizeTile(uint32 tile)
+    {
+        int32 tileX = (int32)(tile % m_tilesX) * TILE_SIZE;
+        int32 tileY = (int32)(tile / m_tilesX) * TILE_SIZE;
 
-        for (int x = (int)p0.x; x < maxX; x++)
+        DepthStats stats;
+        for (uint32 index : m_tileBins[tile])
         {
-            if (steep)
-                m_bitmap.SetPixel(y, x, col);
+            const TriangleSetup& setup = m_binnedTriangles[index];
+            int32 minX = std::max(tileX, setup.minX);
+            int32 minY = std::max(tileY, setup.minY);
+            int32 maxX = std::min(tileX + TILE_SIZE - 1, setup.maxX);
+            int32 maxY = std::min(tileY + TILE_SIZE - 1, setup.maxY);
+
+            if (setup.bDepth)
+                RasterizeTriangleDepth(m_bitmap, m_depthBuffer.get(), setup, minX, minY, maxX, maxY, stats);
             else
-                m_bitmap.SetPixel(x, y, col);
-
-            error -= dy;
-            if (error < 0)
-            {
-                y += ystep;
-                error += dx;
-            }
+                m_rasterizeFunc(m_bitmap, setup, minX, minY, maxX, maxY);
         }
+
+        // Once per tile, the lock is cheap next to rasterizing a tile
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_depthStats += stats;
     }
 
-private:
-    Window&    m_window;
-    Bitmap     m_bitmap;
-    ScanRange *m_scanBuffer;
+    void DiscardBins()
+    {
+        if (m_binnedTriangles.empty())
+            return;
+
+        for (auto& bin : m_tileBins)
+            bin.clear();
+        m_binnedTriangles.clear();
+    }
 
     void FillScanline(ColorB col)
     {
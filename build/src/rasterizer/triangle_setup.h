@@ -0,0 +1,391 @@
+#pragma once
+
+#include "bitmap.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct Point2D
+{
+    f32 x;
+    f32 y;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct Vec3
+{
+    f32 x, y, z;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct Triangle2D
+{
+    Point2D p0;
+    Point2D p1;
+    Point2D p2;
+
+    ColorB c0;
+    ColorB c1;
+    ColorB c2;
+
+    Vec3 ComputeBarycentricCoordinates(const Point2D& p) const
+    {
+        f32 w0 = ((p1.y - p2.y)*(p.x - p2.x) + (p2.x - p1.x)*(p.y - p2.y)) / ((p1.y - p2.y)*(p0.x - p2.x) + (p2.x - p1.x)*(p0.y - p2.y));
+        f32 w1 = ((p2.y - p0.y)*(p.x - p2.x) + (p0.x - p2.x)*(p.y - p2.y)) / ((p1.y - p2.y)*(p0.x - p2.x) + (p2.x - p1.x)*(p0.y - p2.y));
+        f32 w2 = 1 - w1 - w0;
+        return Vec3{ w0, w1, w2 };
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct Triangle3D
+{
+    // Screen space x and y, depth z in [0, 1]
+    Vec3 p0;
+    Vec3 p1;
+    Vec3 p2;
+
+    // Clip space w, attributes are interpolated perspective correct with it
+    f32 w0;
+    f32 w1;
+    f32 w2;
+
+    ColorB c0;
+    ColorB c1;
+    ColorB c2;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Vertex positions are snapped to a fixed point grid with SUBPIXEL_BITS fractional bits
+// before rasterization. Snapped coordinates must stay within the guard band (in pixels):
+// the edge constants and the doubled area reach 8 * (GUARD_BAND * SUBPIXEL_ONE)^2, which
+// has to fit into an int64, so 2^21 is the largest band for 8 subpixel bits. Edges of
+// triangles reaching outside of the band are clipped to it, see SetupClippedEdge().
+////////////////////////////////////////////////////////////////////////////////////////////
+#define SUBPIXEL_BITS   8
+#define SUBPIXEL_ONE    (1 << SUBPIXEL_BITS)
+#define SUBPIXEL_HALF   (SUBPIXEL_ONE >> 1)
+#define GUARD_BAND      (1 << 21)
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Edge equation E(x,y) = A*x + B*y + C in subpixel coordinates, positive on the inner side.
+////////////////////////////////////////////////////////////////////////////////////////////
+struct EdgeFunction
+{
+    int64 A, B, C;
+
+    void Setup(int64 ax, int64 ay, int64 bx, int64 by)
+    {
+        A = ay - by;
+        B = bx - ax;
+        C = -(A * ax + B * ay);
+
+        // Top-left fill rule: a pixel center exactly on an edge only belongs to the triangle
+        // if it is a top or left edge, so pixels on shared edges are filled exactly once.
+        bool bTopLeft = A > 0 || (A == 0 && B > 0);
+        if (!bTopLeft)
+            C -= 1;
+    }
+
+    inline int64 Evaluate(int64 x, int64 y) const { return A * x + B * y + C; }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+struct TriangleSetup
+{
+    // edges[0] is the edge opposite of vertex 0 and so on
+    EdgeFunction edges[3];
+
+    // Bounding box in pixels, clipped to the bitmap
+    int32 minX, minY, maxX, maxY;
+
+    // Color channels (b, g, r, a) at the center of pixel (minX, minY) and their gradients
+    f32 col[4];
+    f32 dColDx[4];
+    f32 dColDy[4];
+
+    // Barycentric weights of the vertices p1 and p2 at the center of pixel (minX, minY) and
+    // their gradients, used to interpolate arbitrary vertex attributes
+    f32 bary[2];
+    f32 dBaryDx[2];
+    f32 dBaryDy[2];
+
+    // Only set up for Triangle3D: depth plane and range, plane of 1/w and of color/w
+    bool bDepth;
+    f32 z, dZdx, dZdy;
+    f32 minZ, maxZ;
+    f32 invW, dInvWdx, dInvWdy;
+    f32 colW[4];
+    f32 dColWdx[4];
+    f32 dColWdy[4];
+
+    // Plane of a vertex attribute at the center of pixel (minX, minY), from the weight planes
+    inline void ComputePlane(f32 a0, f32 a1, f32 a2, f32& val, f32& ddx, f32& ddy) const
+    {
+        val = a0 + (a1 - a0) * bary[0] + (a2 - a0) * bary[1];
+        ddx = (a1 - a0) * dBaryDx[0] + (a2 - a0) * dBaryDx[1];
+        ddy = (a1 - a0) * dBaryDy[0] + (a2 - a0) * dBaryDy[1];
+    }
+
+    // Returns false if the rectangle (in pixels) lies completely outside of an edge
+    bool Overlaps(int32 rectMinX, int32 rectMinY, int32 rectMaxX, int32 rectMaxY) const
+    {
+        const int64 x0 = ((int64)rectMinX << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+        const int64 y0 = ((int64)rectMinY << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+        const int64 x1 = ((int64)rectMaxX << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+        const int64 y1 = ((int64)rectMaxY << SUBPIXEL_BITS) + SUBPIXEL_HALF;
+
+        for (const EdgeFunction& e : edges)
+        {
+            // Corner of the rectangle with the biggest edge value
+            int64 x = e.A > 0 ? x1 : x0;
+            int64 y = e.B > 0 ? y1 : y0;
+            if (e.Evaluate(x, y) < 0)
+                return false;
+        }
+        return true;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+inline uint8 ToUnorm8(f32 val)
+{
+    return uint8(std::min(std::max(val, 0.0f), 255.0f) + 0.5f);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+inline int64 SnapToSubpixels(f32 val)
+{
+    return (int64)lroundf(val * SUBPIXEL_ONE);
+}
+
+inline bool IsInGuardBand(const Point2D& p)
+{
+    return fabsf(p.x) <= (f32)GUARD_BAND && fabsf(p.y) <= (f32)GUARD_BAND;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Sets up the edge from a to b. If an end point lies outside of the guard band, the edge
+// is extended to a whole line and clipped to the band, so the edge function describes the
+// same half plane with coordinates the int64 math can handle. The line is always clipped
+// in the same direction, so two triangles sharing the edge get the same snapped points.
+// Returns false if the band lies completely outside of the edge.
+////////////////////////////////////////////////////////////////////////////////////////////
+inline bool SetupClippedEdge(EdgeFunction& edge, Point2D a, Point2D b)
+{
+    if (IsInGuardBand(a) && IsInGuardBand(b))
+    {
+        edge.Setup(SnapToSubpixels(a.x), SnapToSubpixels(a.y), SnapToSubpixels(b.x), SnapToSubpixels(b.y));
+        return true;
+    }
+
+    const bool bFlipped = a.x > b.x || (a.x == b.x && a.y > b.y);
+    if (bFlipped)
+        std::swap(a, b);
+
+    // Liang-Barsky on the line a + t * (b - a) for all t
+    const f64 band = GUARD_BAND;
+    const f64 dx = (f64)b.x - a.x;
+    const f64 dy = (f64)b.y - a.y;
+    const f64 p[4] = { -dx, dx, -dy, dy };
+    const f64 q[4] = { a.x + band, band - a.x, a.y + band, band - a.y };
+
+    f64 t0 = -HUGE_VAL, t1 = HUGE_VAL;
+    bool bMissed = false;
+    for (int i = 0; i < 4; i++)
+    {
+        if (p[i] == 0.0)
+            bMissed |= q[i] < 0.0;
+        else if (p[i] < 0.0)
+            t0 = std::max(t0, q[i] / p[i]);
+        else
+            t1 = std::min(t1, q[i] / p[i]);
+    }
+
+    const int64 bandSubpixels = (int64)GUARD_BAND << SUBPIXEL_BITS;
+    auto snap = [&](f64 val) { return std::min(std::max((int64)llround(val * SUBPIXEL_ONE), -bandSubpixels), bandSubpixels); };
+
+    int64 x0 = snap(a.x + t0 * dx), y0 = snap(a.y + t0 * dy);
+    int64 x1 = snap(a.x + t1 * dx), y1 = snap(a.y + t1 * dy);
+    if (bMissed || t0 >= t1 || (x0 == x1 && y0 == y1))
+    {
+        // The whole band lies on one side, test its center against the unflipped edge
+        f64 center = bFlipped ? dx * a.y - dy * a.x : dy * a.x - dx * a.y;
+        if (center <= 0.0)
+            return false;
+
+        edge.A = edge.B = edge.C = 0;
+        return true;
+    }
+
+    if (bFlipped)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    edge.Setup(x0, y0, x1, y1);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Color and weight planes from the vertex p0 and the offsets of p1 and p2 to it in pixels,
+// anchored at the center of the first pixel of the bounding box. bSwapped tells whether p1
+// and p2 are swapped relative to the submitted triangle.
+////////////////////////////////////////////////////////////////////////////////////////////
+inline void SetupPlanes(TriangleSetup& setup, f64 x0, f64 y0, f64 dx1, f64 dy1, f64 dx2, f64 dy2,
+                        ColorB c0, ColorB c1, ColorB c2, bool bSwapped)
+{
+    const f64 invArea = 1.0 / (dx1 * dy2 - dy1 * dx2);
+    const f64 anchorX = setup.minX + 0.5 - x0;
+    const f64 anchorY = setup.minY + 0.5 - y0;
+
+    const uint8 v0[4] = { c0.b, c0.g, c0.r, c0.a };
+    const uint8 v1[4] = { c1.b, c1.g, c1.r, c1.a };
+    const uint8 v2[4] = { c2.b, c2.g, c2.r, c2.a };
+    for (int i = 0; i < 4; i++)
+    {
+        f64 d1 = (f64)v1[i] - v0[i];
+        f64 d2 = (f64)v2[i] - v0[i];
+        f64 ddx = (d1 * dy2 - d2 * dy1) * invArea;
+        f64 ddy = (d2 * dx1 - d1 * dx2) * invArea;
+        setup.dColDx[i] = (f32)ddx;
+        setup.dColDy[i] = (f32)ddy;
+        setup.col[i] = (f32)(v0[i] + ddx * anchorX + ddy * anchorY);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        f64 d1 = (i == 0) != bSwapped ? 1.0 : 0.0;
+        f64 d2 = 1.0 - d1;
+        f64 ddx = (d1 * dy2 - d2 * dy1) * invArea;
+        f64 ddy = (d2 * dx1 - d1 * dx2) * invArea;
+        setup.dBaryDx[i] = (f32)ddx;
+        setup.dBaryDy[i] = (f32)ddy;
+        setup.bary[i] = (f32)(ddx * anchorX + ddy * anchorY);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Setup of a triangle with a vertex outside of the guard band. Its edges are clipped to
+// the band, the bounding box and the planes come from the unsnapped vertices.
+////////////////////////////////////////////////////////////////////////////////////////////
+inline bool SetupClippedTriangle(const Triangle2D& t, uint32 width, uint32 height, TriangleSetup& setup)
+{
+    Point2D p0 = t.p0, p1 = t.p1, p2 = t.p2;
+    ColorB c0 = t.c0, c1 = t.c1, c2 = t.c2;
+
+    f64 area = ((f64)p1.x - p0.x) * ((f64)p2.y - p0.y) - ((f64)p1.y - p0.y) * ((f64)p2.x - p0.x);
+    if (area == 0.0)
+        return false;
+
+    bool bSwapped = area < 0.0;
+    if (bSwapped)
+    {
+        std::swap(p1, p2);
+        std::swap(c1, c2);
+    }
+
+    // Clamped before the conversion, the coordinates may not fit into an int32
+    auto toPixel = [](f32 val, uint32 size) { return (int32)std::min(std::max(floorf(val), -1.0f), (f32)size); };
+    setup.minX = std::max(toPixel(std::min({ p0.x, p1.x, p2.x }), width), 0);
+    setup.minY = std::max(toPixel(std::min({ p0.y, p1.y, p2.y }), height), 0);
+    setup.maxX = std::min(toPixel(std::max({ p0.x, p1.x, p2.x }), width), (int32)width - 1);
+    setup.maxY = std::min(toPixel(std::max({ p0.y, p1.y, p2.y }), height), (int32)height - 1);
+    if (setup.minX > setup.maxX || setup.minY > setup.maxY)
+        return false;
+
+    if (!SetupClippedEdge(setup.edges[0], p1, p2) ||
+        !SetupClippedEdge(setup.edges[1], p2, p0) ||
+        !SetupClippedEdge(setup.edges[2], p0, p1))
+        return false;
+
+    SetupPlanes(setup, p0.x, p0.y, (f64)p1.x - p0.x, (f64)p1.y - p0.y, (f64)p2.x - p0.x, (f64)p2.y - p0.y, c0, c1, c2, bSwapped);
+    setup.bDepth = false;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Snaps the triangle to the subpixel grid and computes its edge equations, its bounding
+// box clipped to a width x height target and the gradients of the vertex colors.
+// Returns false if the triangle is degenerate, not finite or covers no pixel of the target.
+////////////////////////////////////////////////////////////////////////////////////////////
+inline bool SetupTriangle(const Triangle2D& t, uint32 width, uint32 height, TriangleSetup& setup)
+{
+    const Point2D* p[3] = { &t.p0, &t.p1, &t.p2 };
+    bool bInGuardBand = true;
+    for (int i = 0; i < 3; i++)
+    {
+        if (!std::isfinite(p[i]->x) || !std::isfinite(p[i]->y))
+            return false;
+        bInGuardBand &= IsInGuardBand(*p[i]);
+    }
+
+    if (!bInGuardBand)
+        return SetupClippedTriangle(t, width, height, setup);
+
+    int64 x0 = SnapToSubpixels(t.p0.x), y0 = SnapToSubpixels(t.p0.y);
+    int64 x1 = SnapToSubpixels(t.p1.x), y1 = SnapToSubpixels(t.p1.y);
+    int64 x2 = SnapToSubpixels(t.p2.x), y2 = SnapToSubpixels(t.p2.y);
+    ColorB c0 = t.c0, c1 = t.c1, c2 = t.c2;
+
+    int64 area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+    if (area == 0)
+        return false;
+
+    // Both windings are accepted, bring the triangle into the one the edge equations expect
+    bool bSwapped = area < 0;
+    if (bSwapped)
+    {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+        std::swap(c1, c2);
+        area = -area;
+    }
+
+    setup.minX = std::max((int32)(std::min({ x0, x1, x2 }) >> SUBPIXEL_BITS), 0);
+    setup.minY = std::max((int32)(std::min({ y0, y1, y2 }) >> SUBPIXEL_BITS), 0);
+    setup.maxX = std::min((int32)(std::max({ x0, x1, x2 }) >> SUBPIXEL_BITS), (int32)width - 1);
+    setup.maxY = std::min((int32)(std::max({ y0, y1, y2 }) >> SUBPIXEL_BITS), (int32)height - 1);
+    if (setup.minX > setup.maxX || setup.minY > setup.maxY)
+        return false;
+
+    setup.edges[0].Setup(x1, y1, x2, y2);
+    setup.edges[1].Setup(x2, y2, x0, y0);
+    setup.edges[2].Setup(x0, y0, x1, y1);
+
+    const f64 toPixels = 1.0 / SUBPIXEL_ONE;
+    SetupPlanes(setup, x0 * toPixels, y0 * toPixels, (x1 - x0) * toPixels, (y1 - y0) * toPixels, (x2 - x0) * toPixels, (y2 - y0) * toPixels,
+                c0, c1, c2, bSwapped);
+
+    setup.bDepth = false;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Like the 2D version, additionally sets up the depth plane and the planes needed for
+// perspective correct colors. Triangles with a vertex behind the eye (w <= 0) are rejected,
+// there is no near plane clipping.
+////////////////////////////////////////////////////////////////////////////////////////////
+inline bool SetupTriangle(const Triangle3D& t, uint32 width, uint32 height, TriangleSetup& setup)
+{
+    if (!(t.w0 > 0.0f && t.w1 > 0.0f && t.w2 > 0.0f))
+        return false;
+
+    Triangle2D t2{ { t.p0.x, t.p0.y }, { t.p1.x, t.p1.y }, { t.p2.x, t.p2.y }, t.c0, t.c1, t.c2 };
+    if (!SetupTriangle(t2, width, height, setup))
+        return false;
+
+    setup.bDepth = true;
+    setup.ComputePlane(t.p0.z, t.p1.z, t.p2.z, setup.z, setup.dZdx, setup.dZdy);
+    setup.minZ = std::min({ t.p0.z, t.p1.z, t.p2.z });
+    setup.maxZ = std::max({ t.p0.z, t.p1.z, t.p2.z });
+
+    f32 invW0 = 1.0f / t.w0, invW1 = 1.0f / t.w1, invW2 = 1.0f / t.w2;
+    setup.ComputePlane(invW0, invW1, invW2, setup.invW, setup.dInvWdx, setup.dInvWdy);
+
+    const uint8 v0[4] = { t.c0.b, t.c0.g, t.c0.r, t.c0.a };
+    const uint8 v1[4] = { t.c1.b, t.c1.g, t.c1.r, t.c1.a };
+    const uint8 v2[4] = { t.c2.b, t.c2.g, t.c2.r, t.c2.a };
+    for (int i = 0; i < 4; i++)
+        setup.ComputePlane(v0[i] * invW0, v1[i] * invW1, v2[i] * invW2, setup.colW[i], setup.dColWdx[i], setup.dColWdy[i]);
+
+    return true;
+}
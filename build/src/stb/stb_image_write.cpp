@@ -0,0 +1,4 @@
+#include <stdafx.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
@@ -3,12 +3,21 @@
 #include <iostream>
 #include <vector>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
 #include <cstdint>
+#include <climits>
+#include <cmath>
 #include <string>
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <type_traits>
 
 using f32     = float;
 using f64     = double;
+using uint8   = uint8_t;
 using uint16  = uint16_t;
 using uint32  = uint32_t;
 using int16   = int16_t;
@@ -18,5 +27,18 @@ using uint64  = uint64_t;
 using string  = std::string;
 
 #ifdef PLATFORM_WIN32
+  #define NOMINMAX
   #include <Windows.h>
+#endif
+
+// Target architecture of the SIMD code paths
+#if defined(_M_X64) || defined(__x86_64__)
+  #define RASTER_X86
+#endif
+
+// Functions using AVX2 intrinsics have to be marked for gcc and clang, msvc allows them anywhere
+#if defined(__GNUC__) || defined(__clang__)
+  #define RASTER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define RASTER_TARGET_AVX2
 #endif
\ No newline at end of file
@@ -17,6 +17,6 @@ public:
     {
         uint64_t dur = OS::PlatformTimer::getTicks() - m_startTicks;
         double durInTime = OS::PlatformTimer::ticksToSeconds(dur);
-        printf_s("<<< %fs has passed >>>\n", durInTime);
+        printf("<<< %fs has passed >>>\n", durInTime);
     }
 };
\ No newline at end of file
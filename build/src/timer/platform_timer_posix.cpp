@@ -0,0 +1,59 @@
+#include <stdafx.h>
+#include "platform_timer.h"
+
+/**********************************************************************
+    class: PlatformTimer (platform_timer_posix.cpp)
+
+    POSIX implementation for precise time measurement.
+    Ticks are nanoseconds of the monotonic clock, so the tick
+    frequency is fixed at 1GHz.
+**********************************************************************/
+
+#ifdef PLATFORM_LINUX
+
+#include <time.h>
+#include <sys/time.h>
+
+namespace OS {
+
+    //----------------------------------------------------------------------
+    void PlatformTimer::_Init()
+    {
+        m_tickFrequency = 1000000000ull;
+        m_tickFrequencyInSeconds = 1.0 / m_tickFrequency;
+    }
+
+    //----------------------------------------------------------------------
+    uint64_t PlatformTimer::getTicks()
+    {
+        timespec ts;
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+
+        return uint64_t( ts.tv_sec ) * 1000000000ull + uint64_t( ts.tv_nsec );
+    }
+
+    //----------------------------------------------------------------------
+    SystemTime PlatformTimer::getCurrentTime()
+    {
+        timeval tv;
+        gettimeofday( &tv, nullptr );
+
+        tm localTime;
+        localtime_r( &tv.tv_sec, &localTime );
+
+        SystemTime st;
+        st.year         = localTime.tm_year + 1900;
+        st.month        = localTime.tm_mon + 1;
+        st.dayOfWeek    = localTime.tm_wday;
+        st.day          = localTime.tm_mday;
+        st.hour         = localTime.tm_hour;
+        st.minute       = localTime.tm_min;
+        st.second       = localTime.tm_sec;
+        st.milliseconds = int( tv.tv_usec / 1000 );
+
+        return st;
+    }
+
+} // end namespaces
+
+#endif // PLATFORM_LINUX
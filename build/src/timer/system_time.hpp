@@ -16,12 +16,12 @@
 // Defines
 //----------------------------------------------------------------------
 
-#define SECOND_IN_MILLIS   1000i64
-#define MINUTE_IN_MILLIS   SECOND_IN_MILLIS * 60i64
-#define HOUR_IN_MILLIS     MINUTE_IN_MILLIS * 60i64
-#define DAY_IN_MILLIS      HOUR_IN_MILLIS   * 24i64
-#define MONTH_IN_MILLIS    DAY_IN_MILLIS    * 30i64
-#define YEAR_IN_MILLIS     MONTH_IN_MILLIS  * 12i64
+#define SECOND_IN_MILLIS   1000LL
+#define MINUTE_IN_MILLIS   SECOND_IN_MILLIS * 60LL
+#define HOUR_IN_MILLIS     MINUTE_IN_MILLIS * 60LL
+#define DAY_IN_MILLIS      HOUR_IN_MILLIS   * 24LL
+#define MONTH_IN_MILLIS    DAY_IN_MILLIS    * 30LL
+#define YEAR_IN_MILLIS     MONTH_IN_MILLIS  * 12LL
 
 namespace OS {
 
@@ -0,0 +1,4 @@
+#!/bin/sh
+# Generates makefiles for Linux. Requires premake5 to be on the PATH.
+cd "$(dirname "$0")/premake"
+premake5 gmake2
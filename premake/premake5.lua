@@ -37,6 +37,11 @@ project "SoftwareRasterizer"
       cppdialect "C++17"
 	  systemversion "latest"
       defines { "PLATFORM_WIN32" }
+
+   filter "system:linux"
+      cppdialect "C++17"
+      defines { "PLATFORM_LINUX" }
+      links { "pthread" }
 		
    filter "configurations:Debug"	  
       defines { "DEBUG" }